@@ -34,74 +34,22 @@ Item {
     // tab's background image shows through. Only the circular gauge
     // elements are drawn.
 
-    // ── Gradient arc (Canvas) ─────────────────────────────────────────────
-    Canvas {
-        id: arcCanvas
+    // ── Dial face (GPU shader) ────────────────────────────────────────────
+    // Disc, track, gradient value arc and threshold tick are drawn by
+    // gauge.frag on a single quad. A new value or threshold only updates
+    // the uniforms below; the scene graph never re-rasterises the arc.
+    ShaderEffect {
         anchors.fill: parent
 
-        onPaint: {
-            var ctx = getContext("2d");
-            ctx.clearRect(0, 0, width, height);
-
-            var cx   = width  / 2;
-            var cy   = height / 2;
-            var r    = Math.min(width, height) / 2 - 20;
-            var lw   = 16;
-
-            // Draw a semi-transparent dark circle behind the gauge face
-            // so tick marks and numbers remain readable over the blue background.
-            ctx.beginPath();
-            ctx.arc(cx, cy, r + lw / 2 + 4, 0, 2 * Math.PI, false);
-            ctx.fillStyle = "rgba(20, 20, 40, 0.82)";
-            ctx.fill();
-
-            // Angle convention: canvas 0 rad = 3 o'clock; we offset by –90°
-            var startRad = (root.minAngle - 90) * Math.PI / 180;
-            var endRad   = (root.maxAngle  - 90) * Math.PI / 180;
-
-            // Gray track
-            ctx.beginPath();
-            ctx.arc(cx, cy, r, startRad, endRad, false);
-            ctx.strokeStyle = "#2d2d44";
-            ctx.lineWidth   = lw;
-            ctx.lineCap     = "round";
-            ctx.stroke();
-
-            // Colored value arc
-            if (root.normalizedValue > 0.005) {
-                var valueRad = startRad + root.normalizedValue * (endRad - startRad);
-                var grad = ctx.createLinearGradient(cx - r, cy, cx + r, cy);
-                grad.addColorStop(0.0, "#2ecc71");
-                grad.addColorStop(0.6, "#f39c12");
-                grad.addColorStop(1.0, "#e74c3c");
-                ctx.beginPath();
-                ctx.arc(cx, cy, r, startRad, valueRad, false);
-                ctx.strokeStyle = grad;
-                ctx.lineWidth   = lw;
-                ctx.lineCap     = "round";
-                ctx.stroke();
-            }
-
-            // White threshold tick
-            var tn = Math.max(0, Math.min(1,
-                (root.threshold - root.minimumValue) /
-                (root.maximumValue - root.minimumValue)));
-            var tr  = startRad + tn * (endRad - startRad);
-            var ri  = r - lw / 2 - 6;
-            var ro  = r + lw / 2 + 6;
-            ctx.beginPath();
-            ctx.moveTo(cx + ri * Math.cos(tr), cy + ri * Math.sin(tr));
-            ctx.lineTo(cx + ro * Math.cos(tr), cy + ro * Math.sin(tr));
-            ctx.strokeStyle = "#ffffff";
-            ctx.lineWidth   = 3;
-            ctx.stroke();
-        }
+        property size itemSize:  Qt.size(width, height)
+        property real value:     root.normalizedValue
+        property real threshold: Math.max(0, Math.min(1,
+            (root.threshold - root.minimumValue) /
+            (root.maximumValue - root.minimumValue)))
+        property real minAngle:  root.minAngle
+        property real maxAngle:  root.maxAngle
 
-        Connections {
-            target: root
-            function onNormalizedValueChanged() { arcCanvas.requestPaint(); }
-            function onThresholdChanged()       { arcCanvas.requestPaint(); }
-        }
+        fragmentShader: "qrc:/new/prefix2/gauge.frag.qsb"
     }
 
     // ── Tick marks + labels ───────────────────────────────────────────────
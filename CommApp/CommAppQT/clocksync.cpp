@@ -0,0 +1,94 @@
+#include "clocksync.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ClockSync::addSample(qint64 sentMs, qint64 deviceMs, qint64 receivedMs)
+{
+    if (receivedMs < sentMs)
+        return;
+
+    Sample s;
+    s.rtt    = receivedMs - sentMs;
+    s.atMs   = sentMs + s.rtt / 2;
+    s.offset = static_cast<double>(deviceMs) - (sentMs + receivedMs) / 2.0;
+
+    if (valid()) {
+        const double predicted = m_offset + m_drift * static_cast<double>(s.atMs - m_refMs);
+        if (std::abs(s.offset - predicted) > kStepMs + s.rtt)
+            reset();
+    }
+
+    m_window[m_next] = s;
+    m_next  = (m_next + 1) % kWindow;
+    m_count = std::min(m_count + 1, kWindow);
+    fit();
+}
+
+// Least squares over the samples whose round trip is within twice the
+// best one (plus a few ms, so a LAN's 0–1 ms jitter does not reject all
+// but one), centred on their mean time to keep the doubles well scaled.
+void ClockSync::fit()
+{
+    m_bestRtt = m_window[0].rtt;
+    for (int i = 1; i < m_count; ++i)
+        m_bestRtt = std::min(m_bestRtt, m_window[i].rtt);
+    const qint64 maxRtt = 2 * m_bestRtt + 5;
+
+    // Times are taken against the newest sample; the best one always
+    // qualifies, so n >= 1.
+    const qint64 anchor = m_window[(m_next + kWindow - 1) % kWindow].atMs;
+    int    n = 0;
+    qint64 first = 0, last = 0;
+    double sumT = 0.0, sumOffset = 0.0;
+    for (int i = 0; i < m_count; ++i) {
+        const Sample &s = m_window[i];
+        if (s.rtt > maxRtt)
+            continue;
+        first = n == 0 ? s.atMs : std::min(first, s.atMs);
+        last  = n == 0 ? s.atMs : std::max(last, s.atMs);
+        sumT      += static_cast<double>(s.atMs - anchor);
+        sumOffset += s.offset;
+        ++n;
+    }
+
+    const double meanOffset = sumOffset / n;
+    m_refMs  = anchor + static_cast<qint64>(std::llround(sumT / n));
+    m_offset = meanOffset;
+    m_drift  = 0.0;
+
+    if (n < 2 || last - first < kMinSpanMs)
+        return;
+
+    double sxx = 0.0, sxy = 0.0;
+    for (int i = 0; i < m_count; ++i) {
+        const Sample &s = m_window[i];
+        if (s.rtt > maxRtt)
+            continue;
+        const double dt = static_cast<double>(s.atMs - m_refMs);
+        sxx += dt * dt;
+        sxy += dt * (s.offset - meanOffset);
+    }
+    if (sxx > 0.0)
+        m_drift = std::clamp(sxy / sxx, -kMaxDrift, kMaxDrift);
+}
+
+// The device reads c = t + offset(t), offset(t) = m_offset + m_drift·(t − ref);
+// solved for t.
+qint64 ClockSync::toServerMs(qint64 deviceMs) const
+{
+    if (!valid())
+        return deviceMs;
+    const double t = (static_cast<double>(deviceMs - m_refMs) - m_offset) / (1.0 + m_drift);
+    return m_refMs + static_cast<qint64>(std::llround(t));
+}
+
+void ClockSync::reset()
+{
+    m_next    = 0;
+    m_count   = 0;
+    m_bestRtt = 0;
+    m_refMs   = 0;
+    m_offset  = 0.0;
+    m_drift   = 0.0;
+}
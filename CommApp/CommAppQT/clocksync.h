@@ -0,0 +1,64 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <QtGlobal>
+
+#include <array>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  ClockSync — where a device's monotonic clock stands against ours.
+//
+//  Every "sync <t1>" / "synced <t1> <c>" exchange gives one sample: the
+//  device read c somewhere between t1 and the arrival time t4, so its
+//  offset is about c − (t1 + t4) / 2, give or take half the round trip
+//  t4 − t1. Like NTP's clock filter, only samples whose round trip is
+//  close to the best one seen recently are trusted — a queued exchange
+//  says more about the queue than about the clock. A least-squares line
+//  through those gives the offset now and its drift (crystal error, or a
+//  device clock that NTP slews), so a stamp from a replay minutes old
+//  maps as well as a live one. A jump far off the line (the device
+//  rebooted, restarting its monotonic clock) discards the history.
+// ─────────────────────────────────────────────────────────────────────────────
+class ClockSync
+{
+public:
+    /** One exchange: our send time, the device's stamp, our receive time. */
+    void addSample(qint64 sentMs, qint64 deviceMs, qint64 receivedMs);
+
+    bool   valid()     const { return m_count > 0; }
+    int    samples()   const { return m_count; }
+    double offsetMs()  const { return m_offset; }          // device − server, at m_refMs
+    double driftPpm()  const { return m_drift * 1e6; }
+    qint64 bestRttMs() const { return m_bestRtt; }
+
+    /** Our time for device stamp `deviceMs`; the stamp itself if no
+     *  exchange has completed yet.                                    */
+    qint64 toServerMs(qint64 deviceMs) const;
+
+    void reset();
+
+private:
+    struct Sample
+    {
+        qint64 atMs   = 0;      // server time of the midpoint
+        double offset = 0.0;
+        qint64 rtt    = 0;
+    };
+
+    static constexpr int    kWindow    = 16;
+    static constexpr qint64 kStepMs    = 2000;     // off the line by more: clock restarted
+    static constexpr double kMaxDrift  = 500e-6;   // far beyond any sane crystal
+    static constexpr qint64 kMinSpanMs = 60000;    // drift needs a minute of history
+
+    void fit();
+
+    std::array<Sample, kWindow> m_window {};
+    int    m_next    = 0;
+    int    m_count   = 0;
+    qint64 m_bestRtt = 0;
+    qint64 m_refMs   = 0;
+    double m_offset  = 0.0;
+    double m_drift   = 0.0;
+};
+
+#endif // CLOCKSYNC_H
@@ -0,0 +1,64 @@
+#include "commandqueue.h"
+
+#include "iotproto/Protocol.h"
+
+#include <algorithm>
+
+void CommandQueue::push(std::string_view keyword, std::string line)
+{
+    for (Command &c : m_queued) {
+        if (c.keyword == keyword) {
+            c.line = std::move(line);
+            return;
+        }
+    }
+    m_queued.push_back({keyword, std::move(line)});
+}
+
+void CommandQueue::flush(qint64 nowMs, const Send &send)
+{
+    while (!m_queued.empty() && (!m_tagged || m_inFlight.size() < kMaxInFlight)) {
+        Command c = std::move(m_queued.front());
+        m_queued.pop_front();
+        if (!m_tagged) {
+            send(c.line);
+            continue;
+        }
+        if (++m_nextId == 0)        // 0 is never a tag
+            ++m_nextId;
+        c.id     = m_nextId;
+        c.sentMs = nowMs;
+        send(proto::tag(c.id, c.line));
+        m_inFlight.push_back(std::move(c));
+    }
+}
+
+bool CommandQueue::complete(quint32 id, qint64 nowMs, Done &done)
+{
+    const auto it = std::find_if(m_inFlight.begin(), m_inFlight.end(),
+                                 [id](const Command &c) { return c.id == id; });
+    if (it == m_inFlight.end())
+        return false;
+    done.keyword = it->keyword;
+    done.line    = std::move(it->line);
+    done.rttMs   = nowMs - it->sentMs;
+    m_inFlight.erase(it);
+    return true;
+}
+
+int CommandQueue::expire(qint64 nowMs)
+{
+    // Sent in order, so the expired ones are a prefix.
+    const auto live = std::find_if(m_inFlight.begin(), m_inFlight.end(),
+                                   [nowMs](const Command &c) { return nowMs - c.sentMs < kTimeoutMs; });
+    const int n = static_cast<int>(live - m_inFlight.begin());
+    m_inFlight.erase(m_inFlight.begin(), live);
+    return n;
+}
+
+void CommandQueue::reset()
+{
+    m_queued.clear();
+    m_inFlight.clear();
+    m_tagged = false;
+}
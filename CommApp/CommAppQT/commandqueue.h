@@ -0,0 +1,82 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <QtGlobal>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  CommandQueue — what the server has to say to one device, and what it is
+//  still waiting to hear back.
+//
+//  Commands are queued in order and sent as soon as the window allows. A
+//  client that sent "mode ids" gets them tagged "#<id> …" with up to
+//  kMaxInFlight outstanding at once; its "#<id> …" answers are matched
+//  here in whatever order they arrive, so a threshold change and a poll
+//  can share a tick and a slow answer never holds up the next command.
+//  A command still waiting to be sent is replaced by a newer one with the
+//  same keyword (the newest threshold wins; a second poll is dropped). An
+//  answer that has not come within kTimeoutMs is given up on — over UDP
+//  the datagram may simply be gone. Clients without tags get plain lines
+//  and nothing is tracked.
+// ─────────────────────────────────────────────────────────────────────────────
+class CommandQueue
+{
+public:
+    static constexpr std::size_t kMaxInFlight = 8;
+    static constexpr qint64      kTimeoutMs   = 10000;
+
+    using Send = std::function<void(const std::string &line)>;
+
+    /** An answered command.                                             */
+    struct Done
+    {
+        std::string_view keyword;
+        std::string      line;
+        qint64           rttMs = 0;
+    };
+
+    /** Queues `line`. `keyword` names the command for coalescing and in
+     *  Done; it must outlive the queue (use the proto:: keyword).       */
+    void push(std::string_view keyword, std::string line);
+
+    /** Sends what the window allows through `send`.                     */
+    void flush(qint64 nowMs, const Send &send);
+
+    /** Matches the answer to `id`; false if it is unknown (never sent,
+     *  already answered or timed out).                                  */
+    bool complete(quint32 id, qint64 nowMs, Done &done);
+
+    /** Gives up on commands unanswered for kTimeoutMs; returns how many. */
+    int expire(qint64 nowMs);
+
+    /** The client answers tags ("mode ids").                            */
+    void setTagged(bool tagged) { m_tagged = tagged; }
+    bool tagged() const { return m_tagged; }
+
+    std::size_t inFlight() const { return m_inFlight.size(); }
+    std::size_t queued()   const { return m_queued.size(); }
+
+    /** Forgets everything: the connection it was for is gone.           */
+    void reset();
+
+private:
+    struct Command
+    {
+        std::string_view keyword;
+        std::string      line;
+        quint32          id     = 0;
+        qint64           sentMs = 0;
+    };
+
+    std::deque<Command>  m_queued;
+    std::vector<Command> m_inFlight;      // at most kMaxInFlight, oldest first
+    quint32              m_nextId = 0;
+    bool                 m_tagged = false;
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,181 @@
+#include "fleetmodel.h"
+
+#include <QBrush>
+#include <QColor>
+#include <QDateTime>
+
+#include <algorithm>
+
+FleetModel::FleetModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    // Single-shot: an idle fleet costs no wakeups. The first markDirty()
+    // after a flush arms it again.
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &FleetModel::flush);
+}
+
+int FleetModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_published;
+}
+
+int FleetModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FleetModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_published)
+        return QVariant();
+
+    const Row &r       = m_rows[static_cast<std::size_t>(index.row())];
+    const bool known   = r.threshold.has_value();
+    const bool ledOn   = known && r.temperature >= *r.threshold;
+
+    if (role == SortRole) {
+        switch (index.column()) {
+        case DeviceColumn:      return r.device;
+        case TemperatureColumn: return r.temperature.toDouble();
+        case ThresholdColumn:   return known ? r.threshold->toDouble() : -1.0;
+        case LedColumn:         return known ? int(ledOn) : -1;
+        case RttColumn:         return r.rttMs;
+        case LastSeenColumn:    return r.lastSeenMs;
+        }
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case DeviceColumn:
+            return r.device;
+        case TemperatureColumn:
+            return QString("%1 °C").arg(r.temperature.toDouble(), 0, 'f', 1);
+        case ThresholdColumn:
+            return known ? QString("%1 °C").arg(r.threshold->toDouble(), 0, 'f', 1)
+                         : QStringLiteral("—");
+        case LedColumn:
+            return known ? QString(ledOn ? "ON" : "OFF") : QStringLiteral("—");
+        case RttColumn:
+            return r.rttMs >= 0 ? QString("%1 ms").arg(r.rttMs)
+                                : QStringLiteral("—");
+        case LastSeenColumn:
+            // Absolute time rather than "n s ago": a relative age would
+            // change every row every second.
+            return QDateTime::fromMSecsSinceEpoch(r.lastSeenMs)
+                       .toString("yyyy-MM-dd hh:mm:ss");
+        }
+        return QVariant();
+    }
+
+    if (role == Qt::ForegroundRole && index.column() == LedColumn && known)
+        return QBrush(QColor(ledOn ? "#e74c3c" : "#2ecc71"));
+
+    if (role == Qt::TextAlignmentRole && index.column() != DeviceColumn)
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+
+    return QVariant();
+}
+
+QVariant FleetModel::headerData(int section, Qt::Orientation orientation,
+                                int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section) {
+    case DeviceColumn:      return QStringLiteral("Device");
+    case TemperatureColumn: return QStringLiteral("Temperature");
+    case ThresholdColumn:   return QStringLiteral("Threshold");
+    case LedColumn:         return QStringLiteral("LED");
+    case RttColumn:         return QStringLiteral("RTT");
+    case LastSeenColumn:    return QStringLiteral("Last seen");
+    }
+    return QVariant();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Updates — record the change, publish it on the next flush
+// ─────────────────────────────────────────────────────────────────────────────
+void FleetModel::updateReading(const QString &device, Milli temperature,
+                               std::optional<Milli> threshold, qint64 timestampMs)
+{
+    const int i = rowFor(device);
+    Row &r = m_rows[static_cast<std::size_t>(i)];
+    r.temperature = temperature;
+    if (threshold)
+        r.threshold = threshold;
+    r.lastSeenMs  = qMax(r.lastSeenMs, timestampMs);
+    markDirty(i);
+}
+
+void FleetModel::updateRtt(const QString &device, qint64 rttMs)
+{
+    const int i = rowFor(device);
+    m_rows[static_cast<std::size_t>(i)].rttMs = rttMs;
+    markDirty(i);
+}
+
+int FleetModel::rowFor(const QString &device)
+{
+    auto it = m_rowOf.constFind(device);
+    if (it != m_rowOf.constEnd())
+        return it.value();
+
+    // Not visible until the next flush publishes it.
+    const int i = static_cast<int>(m_rows.size());
+    Row r;
+    r.device    = device;
+    m_rows.push_back(r);
+    m_isDirty.push_back(0);
+    m_rowOf.insert(device, i);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+    return i;
+}
+
+void FleetModel::markDirty(int row)
+{
+    // Unpublished rows are announced by beginInsertRows() instead.
+    if (row >= m_published || m_isDirty[static_cast<std::size_t>(row)])
+        return;
+    m_isDirty[static_cast<std::size_t>(row)] = 1;
+    m_dirty.push_back(row);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  flush — one dataChanged() per contiguous run of dirty rows, then one
+//  insert for every device that appeared since the last flush.
+// ─────────────────────────────────────────────────────────────────────────────
+void FleetModel::flush()
+{
+    if (!m_dirty.empty()) {
+        std::sort(m_dirty.begin(), m_dirty.end());
+        const QList<int> roles = { Qt::DisplayRole, Qt::ForegroundRole, SortRole };
+
+        std::size_t i = 0;
+        while (i < m_dirty.size()) {
+            std::size_t j = i;
+            while (j + 1 < m_dirty.size() && m_dirty[j + 1] == m_dirty[j] + 1)
+                ++j;
+            emit dataChanged(index(m_dirty[i], 0),
+                             index(m_dirty[j], ColumnCount - 1), roles);
+            i = j + 1;
+        }
+
+        for (int row : m_dirty)
+            m_isDirty[static_cast<std::size_t>(row)] = 0;
+        m_dirty.clear();
+    }
+
+    const int total = static_cast<int>(m_rows.size());
+    if (total > m_published) {
+        beginInsertRows(QModelIndex(), m_published, total - 1);
+        m_published = total;
+        endInsertRows();
+    }
+}
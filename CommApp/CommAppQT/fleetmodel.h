@@ -0,0 +1,88 @@
+#ifndef FLEETMODEL_H
+#define FLEETMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+
+#include "iotproto/Milli.h"
+
+#include <optional>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  FleetModel — one row per device the server has seen: latest temperature,
+//  the threshold it was given, LED state, poll round-trip and last-seen time.
+//
+//  Updates only mark rows dirty. Every kFlushIntervalMs the dirty rows are
+//  sorted, coalesced into contiguous runs and announced with one
+//  dataChanged() per run; rows for new devices are published with a single
+//  beginInsertRows() at the end. A view over thousands of devices therefore
+//  repaints only what changed, at most a few times a second, however fast
+//  the samples arrive.
+//
+//  Display text is for the view; SortRole carries the raw number (or the
+//  device id) so a QSortFilterProxyModel sorts numerically.
+// ─────────────────────────────────────────────────────────────────────────────
+class FleetModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        DeviceColumn,
+        TemperatureColumn,
+        ThresholdColumn,
+        LedColumn,
+        RttColumn,
+        LastSeenColumn,
+        ColumnCount
+    };
+
+    static constexpr int SortRole         = Qt::UserRole;
+    static constexpr int kFlushIntervalMs = 250;
+
+    explicit FleetModel(QObject *parent = nullptr);
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int      columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    /** Latest reading of a device; creates its row on first sight.
+     *  Pass std::nullopt as `threshold` when it is not known (reloaded
+     *  history); a known one is kept.                                  */
+    void updateReading(const QString &device, Milli temperature,
+                       std::optional<Milli> threshold, qint64 timestampMs);
+
+    /** Round trip of the last "get temp" poll, in milliseconds.         */
+    void updateRtt(const QString &device, qint64 rttMs);
+
+private slots:
+    void flush();
+
+private:
+    struct Row
+    {
+        QString              device;
+        Milli                temperature;
+        std::optional<Milli> threshold;       // empty = unknown
+        qint64               rttMs      = -1; // -1 = never polled
+        qint64               lastSeenMs = 0;
+    };
+
+    int  rowFor(const QString &device);
+    void markDirty(int row);
+
+    std::vector<Row>    m_rows;
+    QHash<QString, int> m_rowOf;              // device -> index in m_rows
+    int                 m_published = 0;      // rows the views know about
+
+    std::vector<int>    m_dirty;
+    std::vector<char>   m_isDirty;            // parallel to m_rows
+    QTimer              m_flushTimer;
+};
+
+#endif // FLEETMODEL_H
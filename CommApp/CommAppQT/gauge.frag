@@ -0,0 +1,100 @@
+// gauge.frag
+// Gauge face for Gauge.qml: background disc, grey track, gradient value arc
+// and the threshold tick, all computed per pixel on the GPU. The geometry is
+// a single quad; a new value or threshold only changes a uniform, so nothing
+// is re-rasterised on the CPU. Compiled to gauge.frag.qsb by qt_add_shaders.
+
+#version 440
+
+layout(location = 0) in vec2 qt_TexCoord0;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4  qt_Matrix;
+    float qt_Opacity;
+    vec2  itemSize;          // px
+    float value;             // normalised 0..1
+    float threshold;         // normalised 0..1
+    float minAngle;          // degrees, clockwise from 12 o'clock
+    float maxAngle;
+};
+
+const float kLineWidth = 16.0;
+const vec4  kDisc      = vec4(20.0, 20.0, 40.0, 255.0 * 0.82) / 255.0;
+const vec3  kTrack     = vec3(0x2d, 0x2d, 0x44) / 255.0;
+const vec3  kGreen     = vec3(0x2e, 0xcc, 0x71) / 255.0;
+const vec3  kOrange    = vec3(0xf3, 0x9c, 0x12) / 255.0;
+const vec3  kRed       = vec3(0xe7, 0x4c, 0x3c) / 255.0;
+
+// Premultiplied "over".
+vec4 over(vec4 dst, vec3 rgb, float a)
+{
+    return vec4(rgb * a, a) + dst * (1.0 - a);
+}
+
+// Point on the track circle at `deg` along the gauge sweep.
+vec2 arcPoint(vec2 c, float r, float deg)
+{
+    float rad = radians(deg);
+    return c + r * vec2(sin(rad), -cos(rad));
+}
+
+// Distance from p to the arc of radius r covering [0, sweep] degrees from
+// minAngle; beyond the ends it is the distance to the nearer end, which
+// gives round caps once the half width is subtracted.
+float arcDistance(vec2 p, vec2 c, float r, float u, float sweep)
+{
+    if (u <= sweep)
+        return abs(length(p - c) - r);
+    return min(length(p - arcPoint(c, r, minAngle)),
+               length(p - arcPoint(c, r, minAngle + sweep)));
+}
+
+float segmentDistance(vec2 p, vec2 a, vec2 b)
+{
+    vec2  ab = b - a;
+    float t  = clamp(dot(p - a, ab) / dot(ab, ab), 0.0, 1.0);
+    return length(p - (a + t * ab));
+}
+
+void main()
+{
+    vec2  p     = qt_TexCoord0 * itemSize;
+    vec2  c     = itemSize * 0.5;
+    float r     = min(itemSize.x, itemSize.y) * 0.5 - 20.0;
+    float half_ = kLineWidth * 0.5;
+    float total = maxAngle - minAngle;
+
+    // Angle of p measured like the needle: clockwise from 12 o'clock,
+    // then as an offset along the sweep starting at minAngle.
+    vec2  d   = p - c;
+    float ang = degrees(atan(d.x, -d.y));
+    float u   = mod(ang - minAngle, 360.0);
+
+    vec4 col = vec4(0.0);
+
+    // Background disc behind the face.
+    float disc = clamp(r + half_ + 4.0 - length(d) + 0.5, 0.0, 1.0);
+    col = vec4(kDisc.rgb * kDisc.a, kDisc.a) * disc;
+
+    // Grey track.
+    float track = clamp(half_ - arcDistance(p, c, r, u, total) + 0.5, 0.0, 1.0);
+    col = over(col, kTrack, track);
+
+    // Value arc, coloured by a horizontal gradient across the dial.
+    if (value > 0.005) {
+        float cover = clamp(half_ - arcDistance(p, c, r, u, value * total) + 0.5, 0.0, 1.0);
+        float g     = clamp((p.x - (c.x - r)) / (2.0 * r), 0.0, 1.0);
+        vec3  grad  = g < 0.6 ? mix(kGreen, kOrange, g / 0.6)
+                              : mix(kOrange, kRed, (g - 0.6) / 0.4);
+        col = over(col, grad, cover);
+    }
+
+    // White threshold tick across the track.
+    float tDeg = minAngle + threshold * total;
+    float tick = segmentDistance(p, arcPoint(c, r - half_ - 6.0, tDeg),
+                                    arcPoint(c, r + half_ + 6.0, tDeg));
+    col = over(col, vec3(1.0), clamp(1.5 - tick + 0.5, 0.0, 1.0));
+
+    fragColor = col * qt_Opacity;
+}
@@ -1,10 +1,27 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QTimer>
 
 int main(int argc, char *argv[])
 {
+    // Startup timing report, printed from the first event loop pass after
+    // show() — roughly when the window appears on screen.
+    QElapsedTimer startup;
+    startup.start();
+
     QApplication a(argc, argv);
+    const qint64 appMs = startup.elapsed();
+
     MainWindow w;
+    const qint64 windowMs = startup.elapsed();
+
     w.show();
+    QTimer::singleShot(0, &w, [&startup, appMs, windowMs]() {
+        qInfo("[Startup] QApplication %lld ms, MainWindow %lld ms, shown %lld ms",
+              static_cast<long long>(appMs),
+              static_cast<long long>(windowMs - appMs),
+              static_cast<long long>(startup.elapsed()));
+    });
     return a.exec();
 }
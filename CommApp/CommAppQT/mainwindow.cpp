@@ -7,11 +7,80 @@
 #include <QQmlEngine>
 #include <QPainter>
 #include <QtCharts/QChart>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QPushButton>
+#include <QIntValidator>
+#include <QRegularExpressionValidator>
+#include <QStatusBar>
 
 #include <sys/socket.h>
 #include <unistd.h>
 #include <cstring>
 #include <cerrno>
+#include <vector>
+
+// The Historical Analysis chart shows the last kChartSpanMs of the primary
+// channel, but never fewer than kChartWindow samples, so a slow client still
+// gets a full line. A 100 Hz client puts 6000 samples in the span; anything
+// denser than the plot is decimated per pixel column.
+static constexpr int    kChartWindow = 60;
+static constexpr qint64 kChartSpanMs = 60 * 1000;
+
+// Chart repaints are coalesced to at most one per frame (~30 fps), no
+// matter how fast samples arrive.
+static constexpr int kChartFrameMs = 33;
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  decimateMinMax — reduces (x, y) to at most two points per pixel column:
+//  the minimum and maximum of the samples falling in that column, in their
+//  original order. Peaks and dips survive exactly, and the line the user
+//  sees is the same as if every sample had been drawn.
+// ─────────────────────────────────────────────────────────────────────────────
+static void decimateMinMax(int firstX, const std::vector<Milli> &values,
+                           int columns, QList<QPointF> &out)
+{
+    const std::size_t n = values.size();
+    out.clear();
+
+    if (columns <= 0 || n <= static_cast<std::size_t>(columns) * 2) {
+        out.reserve(static_cast<qsizetype>(n));
+        for (std::size_t i = 0; i < n; ++i)
+            out.append(QPointF(firstX + static_cast<int>(i), values[i].toDouble()));
+        return;
+    }
+
+    out.reserve(static_cast<qsizetype>(columns) * 2);
+    for (int c = 0; c < columns; ++c) {
+        const std::size_t begin = n * static_cast<std::size_t>(c) / columns;
+        const std::size_t end   = n * static_cast<std::size_t>(c + 1) / columns;
+        if (begin == end) continue;
+
+        std::size_t lo = begin, hi = begin;
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            if (values[i] < values[lo]) lo = i;
+            if (values[i] > values[hi]) hi = i;
+        }
+        const std::size_t a = qMin(lo, hi), b = qMax(lo, hi);
+        out.append(QPointF(firstX + static_cast<int>(a), values[a].toDouble()));
+        if (b != a)
+            out.append(QPointF(firstX + static_cast<int>(b), values[b].toDouble()));
+    }
+}
+
+// History reloaded from the on-disk log at startup.
+static constexpr qint64 kReloadMs = 7LL * 24 * 3600 * 1000;
+
+// Clock sync: a "sync" per tick until the estimate has kSyncBurst
+// exchanges, then one every kSyncEveryTicks (about a minute, like NTP's
+// shortest poll interval).
+static constexpr int kSyncBurst      = 4;
+static constexpr int kSyncEveryTicks = 64;
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Constructor
@@ -24,27 +93,146 @@ MainWindow::MainWindow(QWidget *parent)
 
     ui->horizontalSlider->setMinimum(0);
     ui->horizontalSlider->setMaximum(100);
-    ui->horizontalSlider->setValue(static_cast<int>(m_threshold));
-    ui->lcdNumber->display(static_cast<int>(m_threshold));
+    ui->horizontalSlider->setValue(m_threshold.raw / 1000);
+    ui->lcdNumber->display(m_threshold.raw / 1000);
     connect(ui->horizontalSlider, &QSlider::sliderMoved,
             this, &MainWindow::onSliderMoved);
+    setupDeviceSettings();
+
+    setupRules();
 
+    m_chartTimer = new QTimer(this);
+    m_chartTimer->setSingleShot(true);
+    m_chartTimer->setInterval(kChartFrameMs);
+    connect(m_chartTimer, &QTimer::timeout, this, &MainWindow::refreshHistoryChart);
+
+    // Only the status labels are built up front; the QML gauge and the
+    // chart are created the first time their tab is shown.
     setupGaugeTab();
-    setupChartTab();
+    connect(ui->tabWidget, &QTabWidget::currentChanged,
+            this, &MainWindow::onTabChanged);
+    onTabChanged(ui->tabWidget->currentIndex());
 
     m_serverTimer = new QTimer(this);
     m_serverTimer->setInterval(1000);
     connect(m_serverTimer, &QTimer::timeout, this, &MainWindow::onServerTick);
 
+    // Reloading history can take a while on a slow disk; do it once the
+    // window is up. Nothing is received before the user presses Connect.
+    QTimer::singleShot(0, this, &MainWindow::openTelemetryLog);
     updateConnectButton();
 }
 
 MainWindow::~MainWindow()
 {
     stopServer();
+    m_log.close();
     delete ui;
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Alert rules — evaluated server-side on every sample of every device.
+//  "threshold" and "sustained" follow the slider; alerts go to the log,
+//  the status bar and the monitor tab's LED readout.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::setupRules()
+{
+    using Kind = RulesEngine::Kind;
+    const Milli clear = Milli::fromRaw(500);
+    m_rules.setRules({
+        // name          channel  kind                limit                clear  window  debounce
+        { "threshold",   "",      Kind::Threshold,    m_threshold,         clear, 0,      0     },
+        { "sustained",   "",      Kind::Sustained,    m_threshold,         clear, 30000,  0     },
+        { "rising fast", "",      Kind::RateOfChange, Milli::fromUnits(2), clear, 0,      5000  },
+    });
+
+    m_rules.subscribe([](const RulesEngine::Alert &a) {
+        qInfo("[Rules] %s %s on %s/%s (%.2f)",
+              qPrintable(a.rule), a.raised ? "raised" : "cleared",
+              qPrintable(a.device), qPrintable(a.channel), a.value.toDouble());
+    });
+    m_rules.subscribe([this](const RulesEngine::Alert &a) {
+        statusBar()->showMessage(
+            QString("%1 — %2 %3 (%4)")
+                .arg(a.device, a.rule, a.raised ? "raised" : "cleared")
+                .arg(a.value.toDouble(), 0, 'f', 2),
+            5000);
+    });
+    m_rules.subscribe([this](const RulesEngine::Alert &a) {
+        if (a.device == m_deviceId && a.rule == "threshold")
+            updateInfoLabel();
+    });
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Telemetry log — reload the last week into the store, then keep appending
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::openTelemetryLog()
+{
+    const QString dir =
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/telemetry";
+    if (!m_log.open(dir)) {
+        qWarning("[Server] telemetry log disabled (%s)", qPrintable(dir));
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const std::size_t n = m_log.load(
+        QDateTime::currentMSecsSinceEpoch() - kReloadMs,
+        [this](const QString &device, const QString &channel,
+               qint64 timestampMs, Milli value) {
+            m_store.append(device, channel, timestampMs, value);
+        });
+    qInfo("[Server] reloaded %zu sample(s) from %s in %lld ms",
+          n, qPrintable(dir), static_cast<long long>(timer.elapsed()));
+    seedFleet();
+}
+
+// One fleet row per device in the reloaded history, showing its newest
+// primary reading. The threshold those devices ran with is not logged.
+void MainWindow::seedFleet()
+{
+    std::vector<qint64> ts;
+    std::vector<Milli>  values;
+    for (const QString &device : m_store.devices()) {
+        const QStringList chans = m_store.channels(device);
+        if (chans.isEmpty()) continue;
+        const QString primary = chans.contains("temp") ? QStringLiteral("temp")
+                                                       : chans.first();
+        ts.clear();
+        values.clear();
+        if (m_store.tail(device, primary, 1, ts, values) == 0) continue;
+        m_fleet.updateReading(device, values.back(), std::nullopt, ts.back());
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Lazy tab construction
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::onTabChanged(int index)
+{
+    QWidget *page = ui->tabWidget->widget(index);
+    QElapsedTimer timer;
+    timer.start();
+
+    if (page == ui->tab_2 && !m_gaugeWidget) {
+        setupGaugeWidget();
+        qInfo("[Startup] gauge tab built in %lld ms",
+              static_cast<long long>(timer.elapsed()));
+    } else if (page == ui->tab && !m_chartView) {
+        setupChartTab();
+        refreshHistoryChart();
+        qInfo("[Startup] chart tab built in %lld ms",
+              static_cast<long long>(timer.elapsed()));
+    } else if (page == ui->tab_5 && !m_fleetView) {
+        setupFleetTab();
+        qInfo("[Startup] fleet tab built in %lld ms",
+              static_cast<long long>(timer.elapsed()));
+    }
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Tab 1 – Real Time Monitor
 // ─────────────────────────────────────────────────────────────────────────────
@@ -63,6 +251,23 @@ void MainWindow::setupGaugeTab()
         "color:#aaaaaa; font-size:13px; padding:4px;");
     layout->addWidget(m_monitorStatus);
 
+    m_threshInfoLabel = new QLabel(
+        QString("Threshold: %1 °C").arg(m_threshold.toDouble()), tab);
+    m_threshInfoLabel->setAlignment(Qt::AlignCenter);
+    m_threshInfoLabel->setStyleSheet(
+        "color:#cccccc; font-size:13px; font-weight:bold; padding:4px;");
+    layout->addWidget(m_threshInfoLabel);
+
+    tab->setLayout(layout);
+}
+
+// The QQuickWidget (and with it the QML engine) is the most expensive
+// thing in the window; it goes between the two labels on first show.
+void MainWindow::setupGaugeWidget()
+{
+    QWidget *tab = ui->tab_2;
+    auto *layout = static_cast<QVBoxLayout *>(tab->layout());
+
     m_gaugeWidget = new QQuickWidget(tab);
     m_gaugeWidget->setMinimumSize(650, 650);
     m_gaugeWidget->setMaximumSize(900, 900);
@@ -73,16 +278,7 @@ void MainWindow::setupGaugeTab()
     m_gaugeWidget->setClearColor(Qt::transparent);
     m_gaugeWidget->rootContext()->setContextProperty("backend", this);
     m_gaugeWidget->setSource(QUrl("qrc:/new/prefix2/Gauge.qml"));
-    layout->addWidget(m_gaugeWidget, 0, Qt::AlignCenter);
-
-    m_threshInfoLabel = new QLabel(
-        QString("Threshold: %1 °C").arg(m_threshold), tab);
-    m_threshInfoLabel->setAlignment(Qt::AlignCenter);
-    m_threshInfoLabel->setStyleSheet(
-        "color:#cccccc; font-size:13px; font-weight:bold; padding:4px;");
-    layout->addWidget(m_threshInfoLabel);
-
-    tab->setLayout(layout);
+    layout->insertWidget(1, m_gaugeWidget, 0, Qt::AlignCenter);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -103,6 +299,9 @@ void MainWindow::setupChartTab()
 
     m_tempSeries = new QLineSeries();
     m_tempSeries->setName("Temperature (°C)");
+    // Drawn by the GPU instead of QPainter; the decimated point count is
+    // bounded by the plot width either way.
+    m_tempSeries->setUseOpenGL(true);
     m_tempSeries->setColor(QColor("#2ecc71"));
     QPen tp = m_tempSeries->pen();
     tp.setWidth(2);
@@ -115,8 +314,8 @@ void MainWindow::setupChartTab()
     thp.setWidth(2);
     thp.setStyle(Qt::DashLine);
     m_threshSeries->setPen(thp);
-    m_threshSeries->append(0,  m_threshold);
-    m_threshSeries->append(60, m_threshold);
+    m_threshSeries->append(0,  m_threshold.toDouble());
+    m_threshSeries->append(60, m_threshold.toDouble());
 
     auto *chart = new QChart();
     chart->addSeries(m_tempSeries);
@@ -151,12 +350,68 @@ void MainWindow::setupChartTab()
     m_threshSeries->attachAxis(m_axisX);
     m_threshSeries->attachAxis(m_axisY);
 
+    // The decimation depends on the plot width.
+    connect(chart, &QChart::plotAreaChanged,
+            this, &MainWindow::scheduleChartRefresh);
+
     m_chartView = new QChartView(chart, tab);
     m_chartView->setRenderHint(QPainter::Antialiasing);
     layout->addWidget(m_chartView);
     tab->setLayout(layout);
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Tab 3 – Fleet Overview
+//  QTableView only paints visible rows, and fixed row heights keep it from
+//  measuring all of them, so thousands of devices scroll smoothly. The proxy
+//  sorts on FleetModel::SortRole (raw numbers) and filters on the device id.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::setupFleetTab()
+{
+    QWidget *tab = ui->tab_5;
+    auto *layout = new QVBoxLayout(tab);
+    layout->setContentsMargins(30, 30, 30, 30);
+    layout->setSpacing(14);
+
+    auto *filter = new QLineEdit(tab);
+    filter->setPlaceholderText("Filter devices…");
+    filter->setClearButtonEnabled(true);
+    filter->setStyleSheet(
+        "color:white; background:#16213e; border:1px solid #2d2d44;"
+        " border-radius:6px; padding:6px;");
+    layout->addWidget(filter);
+
+    m_fleetProxy = new QSortFilterProxyModel(this);
+    m_fleetProxy->setSourceModel(&m_fleet);
+    m_fleetProxy->setSortRole(FleetModel::SortRole);
+    m_fleetProxy->setFilterKeyColumn(FleetModel::DeviceColumn);
+    m_fleetProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    m_fleetProxy->setDynamicSortFilter(true);
+    connect(filter, &QLineEdit::textChanged,
+            m_fleetProxy, &QSortFilterProxyModel::setFilterFixedString);
+
+    m_fleetView = new QTableView(tab);
+    m_fleetView->setModel(m_fleetProxy);
+    m_fleetView->setSortingEnabled(true);
+    m_fleetView->sortByColumn(FleetModel::DeviceColumn, Qt::AscendingOrder);
+    m_fleetView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_fleetView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_fleetView->setAlternatingRowColors(true);
+    m_fleetView->setWordWrap(false);
+    m_fleetView->verticalHeader()->setVisible(false);
+    m_fleetView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_fleetView->verticalHeader()->setDefaultSectionSize(24);
+    m_fleetView->horizontalHeader()->setStretchLastSection(true);
+    m_fleetView->horizontalHeader()->setDefaultSectionSize(130);
+    m_fleetView->setStyleSheet(
+        "QTableView { color:white; background:#16213e;"
+        " alternate-background-color:#1a1a2e; gridline-color:#2d2d44; }"
+        "QHeaderView::section { color:white; background:#2d2d44;"
+        " border:none; padding:4px; }");
+    layout->addWidget(m_fleetView);
+    tab->setLayout(layout);
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Configuration tab: Connect / Disconnect button
 // ─────────────────────────────────────────────────────────────────────────────
@@ -167,9 +422,16 @@ void MainWindow::on_connectButton_clicked()
         return;
     }
 
-    m_connType = ui->checkBox->isChecked()
-                 ? ConnectionType::TCP
-                 : ConnectionType::UDP;
+    // Anything but the first combo entry overrides the TCP/UDP choice.
+    switch (ui->localTransport->currentIndex()) {
+    case 1:  m_transport = Transport::UnixStream; break;
+    case 2:  m_transport = Transport::UnixDgram;  break;
+    case 3:  m_transport = Transport::Shm;        break;
+    case 4:  m_transport = Transport::TcpUring;   break;
+    default:
+        m_transport = ui->checkBox->isChecked() ? Transport::Tcp : Transport::Udp;
+        break;
+    }
 
     startServer();
 }
@@ -179,10 +441,8 @@ void MainWindow::on_connectButton_clicked()
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::startServer()
 {
-    if (m_connType == ConnectionType::TCP)
-        m_serverChannel.channelSocket = &m_tcpSock;
-    else
-        m_serverChannel.channelSocket = &m_udpSock;
+    m_serverChannel.select(m_transport);
+    m_transport = m_serverChannel.transport();   // io_uring may fall back to epoll
 
     int listenFd = m_serverChannel.startListening();
 
@@ -194,36 +454,55 @@ void MainWindow::startServer()
         return;
     }
 
-    if (m_connType == ConnectionType::TCP) {
+    if (isStream(m_transport)) {
         m_listenNotifier = new QSocketNotifier(
             listenFd, QSocketNotifier::Read, this);
         connect(m_listenNotifier, &QSocketNotifier::activated,
                 this, &MainWindow::onListenFdActivated);
 
         m_monitorStatus->setText(
-            "🔶  Listening on TCP :8080 — waiting for client…");
+            QString("🔶  Listening on %1 — waiting for client…").arg(listenAddress()));
         m_monitorStatus->setStyleSheet(
             "color:#f39c12; font-size:13px; padding:4px;");
 
     } else {
         m_udpClientReady = false;
+        m_clientPushes   = false;
+        m_clientSynced   = false;
         m_udpNotifier = new QSocketNotifier(
             listenFd, QSocketNotifier::Read, this);
         connect(m_udpNotifier, &QSocketNotifier::activated,
                 this, &MainWindow::onUdpFdReadable);
 
         m_monitorStatus->setText(
-            "🔶  Listening on UDP :8081 — waiting for client…");
+            QString("🔶  Listening on %1 — waiting for client…").arg(listenAddress()));
         m_monitorStatus->setStyleSheet(
             "color:#f39c12; font-size:13px; padding:4px;");
     }
 
     ui->checkBox->setEnabled(false);
     ui->checkBox_2->setEnabled(false);
+    ui->localTransport->setEnabled(false);
 
     updateConnectButton();
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  listenAddress — where the selected transport waits, for the status line
+// ─────────────────────────────────────────────────────────────────────────────
+QString MainWindow::listenAddress() const
+{
+    switch (m_transport) {
+    case Transport::Tcp:        return "TCP :8080";
+    case Transport::Udp:        return "UDP :8081";
+    case Transport::UnixStream: return QString("Unix socket %1").arg(kLocalStreamPath);
+    case Transport::UnixDgram:  return QString("Unix datagram socket %1").arg(kLocalDgramPath);
+    case Transport::Shm:        return QString("shared memory via %1").arg(kLocalShmPath);
+    case Transport::TcpUring:   return "TCP :8080 (io_uring)";
+    }
+    return {};
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  stopServer — tears down notifiers and sockets via the OOP interface
 // ─────────────────────────────────────────────────────────────────────────────
@@ -232,15 +511,24 @@ void MainWindow::stopServer()
     m_serverTimer->stop();
     m_clientFd = -1;
     m_udpClientReady = false;
+    m_clientPushes   = false;
+    m_pollPending    = false;
+    m_sessionToken     = 0;
+    m_handshakePending = false;
+    m_clientSynced     = false;
+    commands().reset();
 
     delete m_listenNotifier; m_listenNotifier = nullptr;
     delete m_clientNotifier; m_clientNotifier = nullptr;
+    delete m_writeNotifier;  m_writeNotifier  = nullptr;
     delete m_udpNotifier;    m_udpNotifier    = nullptr;
+    m_txPending.clear();
 
     m_serverChannel.stop();
 
     ui->checkBox->setEnabled(true);
     ui->checkBox_2->setEnabled(true);
+    ui->localTransport->setEnabled(true);
 
     m_monitorStatus->setText(
         "Disconnected — select protocol and press Connect.");
@@ -251,31 +539,58 @@ void MainWindow::stopServer()
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  QSocketNotifier: TCP listen fd readable → new client is waiting to connect
+//  QSocketNotifier: stream listen fd readable → new client is waiting to connect
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::onListenFdActivated(int )
 {
     if (m_clientFd >= 0) return;
 
-    TCPSocket *tcp = static_cast<TCPSocket *>(m_serverChannel.channelSocket);
-    m_clientFd = tcp->acceptConnection();
+    StreamSocket *stream = m_serverChannel.stream();
+    m_clientFd = stream->acceptConnection();
+    m_clientPushes = false;
+    m_pollPending  = false;
+    m_sessionToken = 0;
+    m_clientSynced = false;
 
     if (m_clientFd < 0) {
-        m_monitorStatus->setText("❌  accept() failed.");
+        // The io_uring ring wakes up for more than new connections.
+        if (errno != EAGAIN)
+            m_monitorStatus->setText("❌  accept() failed.");
         return;
     }
 
+    // io_uring reports the client on the ring fd it listens on; one
+    // notifier per fd, so park the listening one until the client leaves.
+    m_listenNotifier->setEnabled(m_clientFd != stream->listenFd());
+
+    setDevice(stream->peerAddress());
+    commands().reset();
+
+    // Polls and threshold updates are single short lines; don't let Nagle
+    // hold them back behind the previous one's ACK.
+    if (!stream->setTxMode(TxMode::LowLatency))
+        qWarning("[Server] TCP_NODELAY failed: %s", strerror(errno));
+
     m_clientNotifier = new QSocketNotifier(
         m_clientFd, QSocketNotifier::Read, this);
     connect(m_clientNotifier, &QSocketNotifier::activated,
             this, &MainWindow::onClientFdReadable);
 
-    const std::string threshMsg =
-        "set threshold " + QString::number(m_threshold, 'f', 1).toStdString();
-    sendToClient(threshMsg);
+    // Enabled only while sendToClient() has bytes the socket did not take.
+    m_txPending.clear();
+    m_writeNotifier = new QSocketNotifier(
+        m_clientFd, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(false);
+    connect(m_writeNotifier, &QSocketNotifier::activated,
+            this, [this](int) { flushToClient(); });
+
+    // The client's first line says whether it resumes a session; the
+    // threshold goes out with the answer (see beginSession).
+    m_handshakePending = true;
 
     m_monitorStatus->setText(
-        QString("✅  TCP client connected (fd %1)").arg(m_clientFd));
+        QString("✅  %1 client connected (fd %2)")
+            .arg(transportName(m_transport)).arg(m_clientFd));
     m_monitorStatus->setStyleSheet(
         "color:#2ecc71; font-size:13px; padding:4px;");
 
@@ -284,12 +599,13 @@ void MainWindow::onListenFdActivated(int )
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  QSocketNotifier: TCP client fd readable → temperature data has arrived
+//  QSocketNotifier: stream client fd readable → temperature data has arrived
 // ─────────────────────────────────────────────────────────────────────────────
-void MainWindow::onClientFdReadable(int fd)
+void MainWindow::onClientFdReadable(int )
 {
+    StreamSocket *stream = m_serverChannel.stream();
     char buf[512] = {};
-    int n = ::recv(fd, buf, sizeof(buf) - 1, 0);
+    ssize_t n = stream->read(buf, sizeof(buf) - 1);
 
     if (n <= 0) {
 
@@ -298,13 +614,22 @@ void MainWindow::onClientFdReadable(int fd)
 
         delete m_clientNotifier;
         m_clientNotifier = nullptr;
-        ::close(m_clientFd);
+        delete m_writeNotifier;
+        m_writeNotifier = nullptr;
+        m_txPending.clear();
+        stream->closeClient();
         m_clientFd = -1;
-        m_recvBuffer.clear();
+        m_rxFramer.clear();
+        m_sessionToken     = 0;            // kept in m_sessions for a resume
+        m_handshakePending = false;
+        m_clientSynced     = false;
+        commands().reset();
         m_serverTimer->stop();
+        m_listenNotifier->setEnabled(true);
 
         m_monitorStatus->setText(
-            "🔶  TCP client disconnected — waiting for reconnect…");
+            QString("🔶  %1 client disconnected — waiting for reconnect…")
+                .arg(transportName(m_transport)));
         m_monitorStatus->setStyleSheet(
             "color:#f39c12; font-size:13px; padding:4px;");
         updateConnectButton();
@@ -312,22 +637,8 @@ void MainWindow::onClientFdReadable(int fd)
     }
 
 
-    m_recvBuffer.append(buf, static_cast<std::size_t>(n));
-
-
-    std::size_t pos;
-    while ((pos = m_recvBuffer.find('\n')) != std::string::npos) {
-        std::string msg = m_recvBuffer.substr(0, pos);
-        m_recvBuffer.erase(0, pos + 1);
-
-
-        if (!msg.empty() && msg.back() == '\r')
-            msg.pop_back();
-
-        if (!msg.empty())
-            handleIncomingData(msg);
-    }
-
+    m_rxFramer.feed(buf, static_cast<std::size_t>(n),
+                    [this](std::string_view line) { handleIncomingData(line); });
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -335,7 +646,7 @@ void MainWindow::onClientFdReadable(int fd)
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::onUdpFdReadable(int )
 {
-    UDPSocket *udp = static_cast<UDPSocket *>(m_serverChannel.channelSocket);
+    DatagramSocket *udp = m_serverChannel.datagram();
     std::string raw = udp->receiveFrom();
 
     while (!raw.empty() && (raw.back() == '\n' || raw.back() == '\r'))
@@ -346,12 +657,15 @@ void MainWindow::onUdpFdReadable(int )
 
     if (!m_udpClientReady) {
         m_udpClientReady = true;
-        m_monitorStatus->setText("✅  UDP client connected — receiving data…");
+        setDevice(udp->peerAddress());
+        commands().reset();
+        m_monitorStatus->setText(QString("✅  %1 client connected — receiving data…")
+                                     .arg(transportName(m_transport)));
         m_monitorStatus->setStyleSheet("color:#2ecc71; font-size:13px; padding:4px;");
 
-        const std::string threshMsg =
-            "set threshold " + QString::number(m_threshold, 'f', 1).toStdString();
-        sendToClient(threshMsg);
+        sendThreshold();
+        sendDeviceSettings();
+        sendSync();
         m_serverTimer->start();
         updateConnectButton();
     }
@@ -364,84 +678,477 @@ void MainWindow::onUdpFdReadable(int )
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::onServerTick()
 {
-    if (m_connType == ConnectionType::TCP && m_clientFd < 0) return;
-    if (m_connType == ConnectionType::UDP && !m_udpClientReady) return;
-
-    if (m_thresholdDirty) {
-
-        const std::string threshMsg =
-            "set threshold " + QString::number(m_threshold, 'f', 1).toStdString();
-        sendToClient(threshMsg);
-        m_thresholdDirty = false;
-    } else {
-        sendToClient("get temp");
+    if (isStream(m_transport) ? m_clientFd < 0 : !m_udpClientReady) return;
+
+    // A client that has said nothing for a whole tick predates sessions
+    // (and is waiting to be polled).
+    if (m_handshakePending)
+        beginSession({});
+    currentSession();   // touching it keeps a connected client's session alive
+    if (--m_syncCountdown <= 0)
+        sendSync();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (const int lost = commands().expire(now))
+        qWarning("[Server] %d command(s) to %s unanswered", lost, qPrintable(m_deviceId));
+
+    // A threshold change and the poll go out in the same tick; with tags
+    // their answers are matched by id, without them "set threshold" has
+    // no answer to confuse with the reading.
+    if (m_thresholdDirty)
+        sendThreshold();
+    if (!m_clientPushes) {
+        // Clients in deadband mode report on their own; polling them
+        // would only generate traffic they are going to filter out.
+        queueCommand(proto::GetTemp::keyword, std::string(proto::GetTemp::keyword));
+        if (!commands().tagged()) {
+            m_pollPending = true;
+            m_pollClock.start();
+        }
     }
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  sendToClient
+//  sendToClient — stream writes never block, so whatever the socket does not
+//  take now is kept in order in m_txPending and written out when the fd
+//  polls writable again; a line is never cut short or reordered.
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::sendToClient(const std::string &msg)
 {
     const std::string line = msg + "\n";
 
-    if (m_connType == ConnectionType::TCP) {
+    if (isStream(m_transport)) {
         if (m_clientFd < 0) return;
+        m_txPending += line;
+        flushToClient();
+    } else {
+        m_serverChannel.datagram()->sendReply(line);
+    }
+}
 
-
-        ssize_t sent = ::send(m_clientFd, line.c_str(), line.size(), MSG_NOSIGNAL);
-        if (sent < 0) {
+void MainWindow::flushToClient()
+{
+    StreamSocket *stream = m_serverChannel.stream();
+    std::size_t off = 0;
+    while (off < m_txPending.size()) {
+        const ssize_t n = stream->write(m_txPending.data() + off, m_txPending.size() - off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0) {
+            // The read side sees the disconnect and cleans up.
             qWarning("[Server] send() failed: %s", strerror(errno));
+            m_txPending.clear();
+            off = 0;
+            break;
         }
+        off += static_cast<std::size_t>(n);
+    }
+    m_txPending.erase(0, off);
+    if (m_writeNotifier)
+        m_writeNotifier->setEnabled(!m_txPending.empty());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Commands — everything the server asks of the device goes through its
+//  CommandQueue, which tags and pipelines them if the client answers tags.
+//  "session" and "sync" are not queued: the first answers the client, the
+//  second times the link itself.
+// ─────────────────────────────────────────────────────────────────────────────
+CommandQueue &MainWindow::commands()
+{
+    return m_commands[m_deviceId];
+}
+
+void MainWindow::queueCommand(std::string_view keyword, std::string line)
+{
+    commands().push(keyword, std::move(line));
+    flushCommands();
+}
+
+void MainWindow::flushCommands()
+{
+    commands().flush(QDateTime::currentMSecsSinceEpoch(),
+                     [this](const std::string &line) { sendToClient(line); });
+}
+
+// "#<id> <reply>": a reading goes through the usual path; a late answer
+// (already timed out) still delivers its reading. The session remembers a
+// threshold only once the device has said "ok" to it.
+void MainWindow::handleReply(quint32 id, std::string_view body)
+{
+    CommandQueue::Done done;
+    if (commands().complete(id, QDateTime::currentMSecsSinceEpoch(), done)) {
+        if (done.keyword == proto::GetTemp::keyword)
+            m_fleet.updateRtt(m_deviceId, done.rttMs);
+        else if (body == proto::kReplyErr)
+            qWarning("[Server] client rejected \"%s\"", done.line.c_str());
+        else if (done.keyword == proto::SetThreshold::keyword && body == proto::kReplyOk)
+            confirmThreshold(std::string_view(done.line).substr(done.keyword.size()));
+        flushCommands();
+    }
+    if (body != proto::kReplyOk && body != proto::kReplyErr)
+        handleIncomingData(body);
+}
+
+// A tagged "set threshold" counts as delivered when its "ok" arrives
+// (confirmThreshold); one still queued or in flight when the link drops
+// is lost with the queue, and the session's old value makes the resume
+// send it again. An untagged client never answers, so for it going out
+// is all the confirmation there is.
+void MainWindow::sendThreshold()
+{
+    const std::string value = m_threshold.toString();
+    queueCommand(proto::SetThreshold::keyword,
+                 std::string(proto::SetThreshold::keyword) + " " + value);
+    m_thresholdDirty = false;
+    if (!commands().tagged())
+        confirmThreshold(value);
+}
+
+void MainWindow::confirmThreshold(std::string_view args)
+{
+    proto::SetThreshold cmd;
+    SessionCache::Session *s = currentSession();
+    if (s && proto::SetThreshold::parse(args, cmd))
+        s->threshold = cmd.value;
+}
+
+// Every key is sent every time, so a newer "set config" that replaces an
+// unsent one in the queue loses nothing. Resent on each connect, since a
+// device that restarted is back on its own file's values.
+void MainWindow::sendDeviceSettings()
+{
+    if (m_deviceSettings.empty())
+        return;
+    if (isStream(m_transport) ? m_clientFd < 0 : !m_udpClientReady)
+        return;
+    queueCommand(proto::SetConfig::keyword,
+                 std::string(proto::SetConfig::keyword) + " " + m_deviceSettings);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Sessions — "resume <token>" as a stream client's first line picks up
+//  where its last connection left off, in the one round trip the answer
+//  takes: "session <token> <n>", then the threshold only if it changed.
+//  An unknown or expired token, or no token, starts a new session.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::beginSession(std::string_view tokenText)
+{
+    m_handshakePending = false;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    quint64 token = SessionCache::parseToken(tokenText);
+    SessionCache::Session *s = token ? m_sessions.find(token, now) : nullptr;
+    const bool resumed = s != nullptr;
+
+    if (resumed) {
+        // Same device even if it came back from another address.
+        setDevice(s->deviceId.toStdString());
+        m_channelNames = s->channelNames;
+        emit channelsChanged(m_channelNames);
+        m_clientPushes = s->pushes;
     } else {
-        static_cast<UDPSocket *>(m_serverChannel.channelSocket)->sendReply(line);
+        token       = m_sessions.create(now);
+        s           = m_sessions.find(token, now);
+        s->deviceId = m_deviceId;
+    }
+    m_sessionToken = token;
+
+    sendToClient(std::string(proto::Session::keyword) + " "
+                 + SessionCache::formatToken(token).toStdString() + " "
+                 + std::to_string(s->records) + " " + batchcodec::supported());
+    if (!resumed || s->threshold != m_threshold)
+        sendThreshold();
+    sendDeviceSettings();
+    sendSync();
+}
+
+SessionCache::Session *MainWindow::currentSession()
+{
+    if (m_sessionToken == 0)
+        return nullptr;
+    return m_sessions.find(m_sessionToken, QDateTime::currentMSecsSinceEpoch());
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Clock sync — "sync <our ms>" out, "synced <our ms> <device ms>" back.
+//  The device's answer feeds its ClockSync; from then on everything it
+//  sends on this connection is stamped with its monotonic clock, which
+//  deviceTime() maps onto ours. Stamps cannot be in the future, so a
+//  live reading is capped at its arrival time.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::sendSync()
+{
+    sendToClient(std::string(proto::Sync::keyword) + " "
+                 + std::to_string(QDateTime::currentMSecsSinceEpoch()));
+    const ClockSync *clock = deviceClock();
+    m_syncCountdown = (clock ? clock->samples() : 0) < kSyncBurst ? 1 : kSyncEveryTicks;
+}
+
+const ClockSync *MainWindow::deviceClock() const
+{
+    const auto it = m_clocks.constFind(m_deviceId);
+    return it == m_clocks.constEnd() || !it->valid() ? nullptr : &*it;
+}
+
+// A batch timestamp: device clock once synced, wall clock before.
+qint64 MainWindow::deviceTime(qint64 stampMs) const
+{
+    const ClockSync *clock = m_clientSynced ? deviceClock() : nullptr;
+    return clock ? clock->toServerMs(stampMs) : stampMs;
+}
+
+// A live reading: its stamp if there is a clock to map it with, else the
+// time it arrived.
+qint64 MainWindow::readingTime(bool stamped, qint64 stampMs) const
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const ClockSync *clock = m_clientSynced ? deviceClock() : nullptr;
+    if (!stamped || !clock)
+        return now;
+    return qMin(clock->toServerMs(stampMs), now);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  handleIncomingData — one line from the client, matched and parsed by the
+//  shared protocol definition (Protocol.h)
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::handleIncomingData(std::string_view raw)
+{
+    const std::string_view resume = proto::Resume::keyword;
+    if (m_handshakePending && proto::trim(raw).substr(0, resume.size()) != resume)
+        beginSession({});
+
+    quint32 id = 0;
+    if (proto::splitTag(raw, id)) {
+        handleReply(id, raw);
+        return;
     }
+
+    proto::Handlers handler {
+        [this](const proto::Batch &batch) { handleBatch(batch); },
+        [this](const proto::ZBatch &batch) { handleZBatch(batch); },
+        [this](const proto::Frame &frame) { handleFrame(frame); },
+        [this](const proto::Channels &c) {
+            m_channelNames = QString::fromUtf8(c.names.data(),
+                                               static_cast<qsizetype>(c.names.size()))
+                                 .split(',', Qt::SkipEmptyParts);
+            emit channelsChanged(m_channelNames);
+            if (SessionCache::Session *s = currentSession())
+                s->channelNames = m_channelNames;
+        },
+        [this](const proto::Mode &m) {
+            if (m.mode == "push" || m.mode == "poll") {
+                // "poll": its deadband was set back to 0 (set config).
+                m_clientPushes = m.mode == "push";
+                if (SessionCache::Session *s = currentSession())
+                    s->pushes = m_clientPushes;
+            } else if (m.mode == "ids") {
+                commands().setTagged(true);
+            }
+        },
+        [this](const proto::Resume &r) {
+            if (m_handshakePending)
+                beginSession(r.token);
+        },
+        [this](const proto::Synced &s) {
+            m_clocks[m_deviceId].addSample(s.serverMs, s.clientMs,
+                                           QDateTime::currentMSecsSinceEpoch());
+            m_clientSynced = true;
+        },
+        [this](const proto::Reading &r) {
+            if (m_pollPending) {
+                m_pollPending = false;
+                m_fleet.updateRtt(m_deviceId, m_pollClock.elapsed());
+            }
+            recordSample(primaryChannel(), readingTime(r.stamped, r.stampMs), r.value, true);
+            setLiveTemperature(r.value);
+        },
+    };
+
+    if (proto::dispatch(raw, handler) != proto::Result::Handled)
+        qWarning("[Server] ignored line from client: %.*s",
+                 static_cast<int>(raw.size()), raw.data());
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  handleIncomingData — parse temperature reading and update GUI
+//  handleFrame — one sampling pass of a multi-sensor client,
+//  "<v0>,<v1>,…" in the order of its last "channels" line. Channel 0 is
+//  the primary temperature and drives the gauge; the rest go to the store.
 // ─────────────────────────────────────────────────────────────────────────────
-void MainWindow::handleIncomingData(const std::string &raw)
+void MainWindow::handleFrame(const proto::Frame &frame)
 {
-    bool ok = false;
-    double temp = QString::fromStdString(raw).toDouble(&ok);
-    if (!ok) return;
+    const qint64 ts = readingTime(frame.stamped, frame.stampMs);
+
+    frame.forEach([&](std::size_t index, Milli v) {
+        const int i = static_cast<int>(index);
+        // A frame that arrives before its "channels" line (UDP loss,
+        // server restart) still lands under a stable positional name.
+        const QString name = i < m_channelNames.size()
+                             ? m_channelNames[i]
+                             : (i == 0 ? primaryChannel() : QString("ch%1").arg(i));
+        recordSample(name, ts, v, true);
+        if (i == 0)
+            setLiveTemperature(v);
+    });
+}
 
-    m_temperature = temp;
-    emit temperatureChanged(m_temperature);
-    addTemperatureSample(m_temperature);
+// Every reading goes to the in-memory store and through the writer thread
+// to the on-disk log. Only live readings go through the alert rules: a
+// replayed one can be hours old and says nothing about the device now.
+void MainWindow::recordSample(const QString &channel, qint64 timestampMs, Milli value,
+                              bool live)
+{
+    m_store.append(m_deviceId, channel, timestampMs, value);
+    m_log.append(m_deviceId, channel, timestampMs, value);
+    if (live)
+        m_rules.evaluate(m_deviceId, channel, channel == primaryChannel(),
+                         timestampMs, value);
+}
+
+void MainWindow::setLiveTemperature(Milli temp)
+{
+    m_fleet.updateReading(m_deviceId, temp, m_threshold,
+                          QDateTime::currentMSecsSinceEpoch());
+    emit temperatureChanged(temp.toDouble());
+    scheduleChartRefresh();
     updateInfoLabel();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-//  Chart helper
+//  Per-device bookkeeping. A (re)connecting client starts with no channel
+//  layout until it announces one; its stored history is kept.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::setDevice(const std::string &address)
+{
+    const QString id = QString::fromStdString(address);
+    m_channelNames.clear();
+    emit channelsChanged(m_channelNames);
+    if (id != m_deviceId) {
+        m_deviceId = id;
+        emit deviceChanged(m_deviceId);
+        scheduleChartRefresh();  // show what the log remembers of it
+    }
+}
+
+QString MainWindow::primaryChannel() const
+{
+    return m_channelNames.isEmpty() ? QStringLiteral("temp")
+                                    : m_channelNames.first();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  handleBatch — readings the client spooled while it was disconnected,
+//  "<ms>:<temp>,<ms>:<temp>,…". They go into the history only; the gauge
+//  keeps showing the live value and the alert rules do not see them.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::handleBatch(const proto::Batch &batch)
+{
+    const QString channel = primaryChannel();
+    quint64 records = 0;
+    batch.forEach([&](int64_t ts, Milli temp) {
+        recordSample(channel, deviceTime(ts), temp, false);
+        ++records;
+    });
+    countBatchRecords(records);
+    scheduleChartRefresh();
+}
+
+// The same readings delta/varint-encoded (BatchCodec.h); decoded whole, so
+// a damaged line stores nothing.
+void MainWindow::handleZBatch(const proto::ZBatch &batch)
+{
+    if (!batchcodec::decode(batch.codec, batch.payload, m_zbatchScratch)) {
+        qWarning("[Server] undecodable zbatch (codec %.*s)",
+                 static_cast<int>(batch.codec.size()), batch.codec.data());
+        return;
+    }
+    const QString channel = primaryChannel();
+    for (const batchcodec::Record &r : m_zbatchScratch)
+        recordSample(channel, deviceTime(r.timestampMs), r.value, false);
+    countBatchRecords(m_zbatchScratch.size());
+    scheduleChartRefresh();
+}
+
+// Counted per session so a resuming client skips what already arrived.
+void MainWindow::countBatchRecords(quint64 records)
+{
+    if (SessionCache::Session *s = currentSession())
+        s->records += records;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Chart helper — the chart shows the newest kChartSpanMs of the primary
+//  channel, read back from the store and reduced to at most two points per
+//  pixel column, so the QLineSeries stays small at any sample rate.
+//  Callers go through scheduleChartRefresh(), which coalesces a burst of
+//  samples into one repaint per kChartFrameMs.
 // ─────────────────────────────────────────────────────────────────────────────
-void MainWindow::addTemperatureSample(double temp)
+void MainWindow::scheduleChartRefresh()
+{
+    if (m_chartView && !m_chartTimer->isActive())
+        m_chartTimer->start();
+}
+
+void MainWindow::refreshHistoryChart()
 {
-    m_tempSeries->append(m_sampleIndex, temp);
-    ++m_sampleIndex;
+    if (!m_chartView) return;   // built on first visit to the tab
+
+    const QString channel = primaryChannel();
+    std::vector<qint64> ts;
+    std::vector<Milli>  values;
+    if (m_store.tail(m_deviceId, channel, 1, ts, values) == 0) return;
+
+    // Anchored at the newest sample rather than "now", so reloaded history
+    // of an offline device still shows its last minute.
+    const qint64 newest = ts.back();
+    ts.clear();
+    values.clear();
+    m_store.query(m_deviceId, channel, newest - kChartSpanMs, newest, ts, values);
+    if (values.size() < static_cast<std::size_t>(kChartWindow)) {
+        ts.clear();
+        values.clear();
+        m_store.tail(m_deviceId, channel, kChartWindow, ts, values);
+    }
+
+    const int total  = static_cast<int>(m_store.size(m_deviceId, channel));
+    const int window = qMax(kChartWindow, static_cast<int>(values.size()));
+    const int first  = total - static_cast<int>(values.size());
 
-    int xMin = qMax(0, m_sampleIndex - 60);
-    int xMax = qMax(60, m_sampleIndex);
+    Milli lo = m_threshold, hi = m_threshold;
+    for (Milli v : values) {
+        lo = qMin(lo, v);
+        hi = qMax(hi, v);
+    }
+
+    QList<QPointF> points;
+    decimateMinMax(first, values,
+                   static_cast<int>(m_chartView->chart()->plotArea().width()),
+                   points);
+    m_tempSeries->replace(points);
+
+    int xMin = qMax(0, total - window);
+    int xMax = qMax(window, total);
     m_axisX->setRange(xMin, xMax);
 
     m_threshSeries->clear();
-    m_threshSeries->append(xMin, m_threshold);
-    m_threshSeries->append(xMax, m_threshold);
+    m_threshSeries->append(xMin, m_threshold.toDouble());
+    m_threshSeries->append(xMax, m_threshold.toDouble());
 
-    double yMin = qMin(temp, m_threshold) - 10.0;
-    double yMax = qMax(temp, m_threshold) + 10.0;
-    m_axisY->setRange(qMax(0.0, yMin), qMin(150.0, yMax));
+    m_axisY->setRange(qMax(0.0, lo.toDouble() - 10.0), qMin(150.0, hi.toDouble() + 10.0));
 }
 
 void MainWindow::updateInfoLabel()
 {
     if (!m_threshInfoLabel) return;
-    const bool ledOn = (m_temperature >= m_threshold);
+    const double temp  = currentTemperature();
+    const bool   ledOn = m_rules.isActive(m_deviceId, "threshold");
     m_threshInfoLabel->setText(
         QString("Temp: %1 °C  |  Threshold: %2 °C  |  LED: %3")
-            .arg(m_temperature, 0, 'f', 1)
-            .arg(m_threshold,   0, 'f', 1)
+            .arg(temp,          0, 'f', 1)
+            .arg(threshold(),   0, 'f', 1)
             .arg(ledOn ? "ON  🔴" : "OFF  🟢"));
 }
 
@@ -482,9 +1189,11 @@ void MainWindow::updateConnectButton()
 // ─────────────────────────────────────────────────────────────────────────────
 void MainWindow::onSliderMoved(int value)
 {
-    m_threshold = static_cast<double>(value);
+    m_threshold = Milli::fromUnits(value);
     ui->lcdNumber->display(value);
-    emit thresholdChanged(m_threshold);
+    emit thresholdChanged(threshold());
+    m_rules.setLimit("threshold", m_threshold);
+    m_rules.setLimit("sustained", m_threshold);
 
     if (m_threshold != m_prevThreshold) {
         m_thresholdDirty = true;
@@ -494,6 +1203,63 @@ void MainWindow::onSliderMoved(int value)
     updateInfoLabel();
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Configuration tab: device settings — sample rate, replay batch size and
+//  deadband, pushed to connected devices with "set config" so the fleet
+//  can be re-tuned without restarting it. An empty field leaves the
+//  device's own value alone.
+// ─────────────────────────────────────────────────────────────────────────────
+void MainWindow::setupDeviceSettings()
+{
+    auto *box  = new QGroupBox("Device settings", ui->tab_3);
+    auto *form = new QFormLayout(box);
+
+    auto field = [box](const QString &placeholder, QValidator *validator) {
+        auto *edit = new QLineEdit(box);
+        edit->setPlaceholderText(placeholder);
+        edit->setValidator(validator);
+        return edit;
+    };
+    // Not QDoubleValidator: it takes the locale's decimal comma, which
+    // the device would reject.
+    m_sampleMsEdit  = field("device default", new QIntValidator(10, 3600 * 1000, box));
+    m_batchSizeEdit = field("device default", new QIntValidator(1, 2048, box));
+    m_deadbandEdit  = field("device default",
+                            new QRegularExpressionValidator(QRegularExpression("\\d{1,6}(\\.\\d{1,3})?"), box));
+    form->addRow("Sample period (ms)", m_sampleMsEdit);
+    form->addRow("Replay batch size", m_batchSizeEdit);
+    form->addRow("Deadband (°C)", m_deadbandEdit);
+
+    auto *apply = new QPushButton("Apply to device", box);
+    connect(apply, &QPushButton::clicked, this, &MainWindow::onApplyDeviceSettings);
+    form->addRow(apply);
+
+    ui->horizontalLayout_4->addWidget(box);
+}
+
+void MainWindow::onApplyDeviceSettings()
+{
+    std::string settings;
+    auto add = [&settings](const char *key, const QLineEdit *edit) {
+        const QString text = edit->text().trimmed();
+        if (text.isEmpty() || !edit->hasAcceptableInput())
+            return;
+        if (!settings.empty())
+            settings += ' ';
+        settings += std::string(key) + "=" + text.toStdString();
+    };
+    add("sample_ms",  m_sampleMsEdit);
+    add("batch_size", m_batchSizeEdit);
+    add("deadband",   m_deadbandEdit);
+
+    m_deviceSettings = settings;
+    sendDeviceSettings();
+    statusBar()->showMessage(settings.empty()
+                                 ? QString("Device settings cleared")
+                                 : QString("Device settings: %1").arg(QString::fromStdString(settings)),
+                             5000);
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Quick Access buttons
 // ─────────────────────────────────────────────────────────────────────────────
@@ -13,16 +13,28 @@
 #include <QtCharts/QValueAxis>
 #include <QVBoxLayout>
 #include <QLabel>
-
-#include "Socket.h"
-#include "Channel.h"
+#include <QLineEdit>
+#include <QTableView>
+#include <QSortFilterProxyModel>
+#include <QElapsedTimer>
+
+#include "iotproto/Socket.h"
+#include "iotproto/Channel.h"
+#include "iotproto/LineFramer.h"
+#include "iotproto/Protocol.h"
+#include "iotproto/BatchCodec.h"
+#include "seriesstore.h"
+#include "telemetrylog.h"
+#include "fleetmodel.h"
+#include "rulesengine.h"
+#include "sessioncache.h"
+#include "clocksync.h"
+#include "commandqueue.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
-enum class ConnectionType { TCP, UDP };
-
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -39,12 +51,31 @@ public:
                READ   threshold
                NOTIFY thresholdChanged)
 
-    double currentTemperature() const { return m_temperature; }
-    double threshold()          const { return m_threshold;   }
+    Q_PROPERTY(QString currentDevice
+               READ    currentDevice
+               NOTIFY  deviceChanged)
+
+    Q_PROPERTY(QStringList channels
+               READ        channels
+               NOTIFY      channelsChanged)
+
+    // Primary channel of the connected device (what the gauge shows).
+    double      currentTemperature() const
+    { return m_store.latest(m_deviceId, primaryChannel()).toDouble(); }
+    double      threshold()     const { return m_threshold.toDouble(); }
+    QString     currentDevice() const { return m_deviceId;     }
+    QStringList channels()      const { return m_channelNames; }
+
+    /** Newest reading of any device/channel the server has seen.        */
+    Q_INVOKABLE double latestValue(const QString &device,
+                                   const QString &channel) const
+    { return m_store.latest(device, channel).toDouble(); }
 
 signals:
     void temperatureChanged(double temp);
     void thresholdChanged(double threshold);
+    void deviceChanged(const QString &device);
+    void channelsChanged(const QStringList &channels);
 
 private slots:
     // ── Quick Access tab ──────────────────────────────────────────────────────
@@ -54,10 +85,14 @@ private slots:
 
     // ── Configuration tab ─────────────────────────────────────────────────────
     void onSliderMoved(int value);
+    void onApplyDeviceSettings();
 
     // Auto-connected by Qt name convention (on_<objectName>_clicked)
     void on_connectButton_clicked();
 
+    // Builds a tab's contents the first time it is shown.
+    void onTabChanged(int index);
+
     // ── Protocol timer (1 s) ─────────────────────────────────────────────────
     void onServerTick();
 
@@ -81,39 +116,95 @@ private:
     QLineSeries  *m_threshSeries    = nullptr;
     QValueAxis   *m_axisX           = nullptr;
     QValueAxis   *m_axisY           = nullptr;
-    int           m_sampleIndex     = 0;
+
+    // Tab 3
+    QTableView            *m_fleetView  = nullptr;
+    QSortFilterProxyModel *m_fleetProxy = nullptr;
+
+    // Configuration tab: device settings ("set config")
+    QLineEdit    *m_sampleMsEdit    = nullptr;
+    QLineEdit    *m_batchSizeEdit   = nullptr;
+    QLineEdit    *m_deadbandEdit    = nullptr;
 
     // ── Application state ─────────────────────────────────────────────────────
-    double         m_temperature    = 0.0;
-    double         m_threshold      = 50.0;
-    double         m_prevThreshold  = 50.0;
+    SeriesStore    m_store;
+    TelemetryLog   m_log;
+    FleetModel     m_fleet;
+    RulesEngine    m_rules;
+    SessionCache   m_sessions;
+    QHash<QString, ClockSync> m_clocks;        // per device id, from "synced"
+    QHash<QString, CommandQueue> m_commands;   // per device id, outbound
+    QString        m_deviceId;                 // peer address of the client
+    QStringList    m_channelNames;             // from "channels …"; empty = single sensor
+    Milli          m_threshold      = Milli::fromUnits(50);
+    Milli          m_prevThreshold  = Milli::fromUnits(50);
     bool           m_thresholdDirty = false;
-    ConnectionType m_connType       = ConnectionType::TCP;
+    std::string    m_deviceSettings;           // "set config" arguments; empty = device defaults
+    Transport      m_transport      = Transport::Tcp;
 
-    TCPSocket      m_tcpSock;
-    UDPSocket      m_udpSock;
-    ServerChannel  m_serverChannel;
+    ServerChannel  m_serverChannel;            // owns the selected socket
 
     int            m_clientFd = -1;
     bool           m_udpClientReady = false;
+    bool           m_clientPushes   = false;   // client sent "mode push"
+    bool           m_pollPending    = false;   // untagged "get temp" sent, no reply yet
+    QElapsedTimer  m_pollClock;                // RTT of that poll
+    quint64        m_sessionToken     = 0;     // stream client's session, 0 = none
+    bool           m_handshakePending = false; // accepted, first line not seen yet
+    bool           m_clientSynced     = false; // answered "sync": stamps are its clock
+    int            m_syncCountdown    = 0;     // ticks until the next "sync"
 
-    std::string    m_recvBuffer;
+    LineFramer     m_rxFramer;
+    std::string    m_txPending;                // stream bytes the socket has not taken yet
+    std::vector<batchcodec::Record> m_zbatchScratch;   // reused by handleZBatch
 
 
     QSocketNotifier *m_listenNotifier = nullptr;
     QSocketNotifier *m_clientNotifier = nullptr;
+    QSocketNotifier *m_writeNotifier  = nullptr;   // stream client, while m_txPending
     QSocketNotifier *m_udpNotifier    = nullptr;
 
     QTimer *m_serverTimer = nullptr;
+    QTimer *m_chartTimer  = nullptr;           // coalesces chart repaints
 
     // ── Helpers ───────────────────────────────────────────────────────────────
     void setupGaugeTab();
+    void setupGaugeWidget();
     void setupChartTab();
+    void setupFleetTab();
+    void setupRules();
+    void setupDeviceSettings();
+    void seedFleet();
     void startServer();
     void stopServer();
+    QString listenAddress() const;
     void sendToClient(const std::string &msg);
-    void handleIncomingData(const std::string &raw);
-    void addTemperatureSample(double temp);
+    void flushToClient();
+    CommandQueue &commands();
+    void queueCommand(std::string_view keyword, std::string line);
+    void flushCommands();
+    void handleReply(quint32 id, std::string_view body);
+    void sendThreshold();
+    void confirmThreshold(std::string_view args);
+    void sendDeviceSettings();
+    void beginSession(std::string_view token);
+    SessionCache::Session *currentSession();
+    void sendSync();
+    const ClockSync *deviceClock() const;
+    qint64 deviceTime(qint64 stampMs) const;
+    qint64 readingTime(bool stamped, qint64 stampMs) const;
+    void handleIncomingData(std::string_view raw);
+    void handleBatch(const proto::Batch &batch);
+    void handleZBatch(const proto::ZBatch &batch);
+    void countBatchRecords(quint64 records);
+    void handleFrame(const proto::Frame &frame);
+    void setDevice(const std::string &address);
+    void setLiveTemperature(Milli temp);
+    void recordSample(const QString &channel, qint64 timestampMs, Milli value, bool live);
+    void openTelemetryLog();
+    QString primaryChannel() const;
+    void scheduleChartRefresh();
+    void refreshHistoryChart();
     void updateInfoLabel();
     void updateConnectButton();
 };
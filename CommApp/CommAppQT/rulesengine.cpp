@@ -0,0 +1,161 @@
+#include "rulesengine.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Compilation — rules sorted by channel into one contiguous array, with a
+//  [first, last) slice per channel. The primary-channel rules (empty
+//  channel) sort first.
+// ─────────────────────────────────────────────────────────────────────────────
+void RulesEngine::setRules(const std::vector<Rule> &rules)
+{
+    m_rules = rules;
+    m_compiled.clear();
+    m_byChannel.clear();
+    m_states.clear();
+    m_primary = Range(0, 0);
+
+    std::vector<int> order(m_rules.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_rules[a].channel < m_rules[b].channel;
+    });
+
+    m_compiled.reserve(order.size());
+    for (int i : order) {
+        const Rule &r = m_rules[i];
+        m_compiled.push_back({ r.kind, r.limit, qMax(Milli(), r.clearBand),
+                               qMax<qint64>(0, r.windowMs),
+                               qMax<qint64>(0, r.debounceMs), i });
+    }
+
+    std::size_t first = 0;
+    while (first < m_compiled.size()) {
+        const QString &channel = m_rules[m_compiled[first].source].channel;
+        std::size_t last = first + 1;
+        while (last < m_compiled.size()
+               && m_rules[m_compiled[last].source].channel == channel)
+            ++last;
+        const Range range(static_cast<int>(first), static_cast<int>(last));
+        if (channel.isEmpty())
+            m_primary = range;
+        else
+            m_byChannel.insert(channel, range);
+        first = last;
+    }
+}
+
+void RulesEngine::setLimit(const QString &name, Milli limit)
+{
+    for (Compiled &c : m_compiled) {
+        if (m_rules[c.source].name == name) {
+            c.limit = limit;
+            m_rules[c.source].limit = limit;
+        }
+    }
+}
+
+bool RulesEngine::isActive(const QString &device, const QString &name) const
+{
+    auto it = m_states.constFind(device);
+    if (it == m_states.constEnd())
+        return false;
+    for (std::size_t i = 0; i < m_compiled.size(); ++i) {
+        if (m_rules[m_compiled[i].source].name == name && it.value()[i].active)
+            return true;
+    }
+    return false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Evaluation
+// ─────────────────────────────────────────────────────────────────────────────
+void RulesEngine::evaluate(const QString &device, const QString &channel, bool primary,
+                           qint64 timestampMs, Milli value)
+{
+    if (m_compiled.empty())
+        return;
+
+    std::vector<State> &states = m_states[device];
+    if (states.size() != m_compiled.size())
+        states.resize(m_compiled.size());
+
+    if (primary && m_primary.first != m_primary.second)
+        run(m_primary, states, device, channel, timestampMs, value);
+
+    auto it = m_byChannel.constFind(channel);
+    if (it != m_byChannel.constEnd())
+        run(it.value(), states, device, channel, timestampMs, value);
+}
+
+void RulesEngine::run(const Range &range, std::vector<State> &states,
+                      const QString &device, const QString &channel,
+                      qint64 timestampMs, Milli value)
+{
+    for (int i = range.first; i < range.second; ++i) {
+        const Compiled &c = m_compiled[static_cast<std::size_t>(i)];
+        State          &s = states[static_cast<std::size_t>(i)];
+
+        bool  over  = false;
+        bool  under = false;                // far enough below to clear
+        Milli seen  = value;
+
+        switch (c.kind) {
+        case Kind::Threshold:
+            over  = value >= c.limit;
+            under = value <  c.limit - c.clearBand;
+            break;
+
+        case Kind::RateOfChange: {
+            const qint64 dt = timestampMs - s.prevTs;
+            const bool   ok = s.hasPrev && dt > 0;
+            if (ok) {
+                // Thousandths per ms → thousandths per second, saturating.
+                // Signed: a falling reading has a negative rate.
+                const int64_t step = int64_t(value.raw) - s.prevValue.raw;
+                seen = Milli::fromRaw(static_cast<int32_t>(
+                    std::clamp<int64_t>(step * 1000 / dt, INT32_MIN, INT32_MAX)));
+            }
+            s.prevTs    = timestampMs;
+            s.prevValue = value;
+            s.hasPrev   = true;
+            if (!ok)
+                continue;
+            over  = seen >= c.limit;
+            under = seen <  c.limit - c.clearBand;
+            break;
+        }
+
+        case Kind::Sustained:
+            if (value >= c.limit) {
+                if (s.since < 0)
+                    s.since = timestampMs;
+            } else if (value < c.limit - c.clearBand) {
+                s.since = -1;
+            }
+            over  = s.since >= 0 && timestampMs - s.since >= c.windowMs;
+            under = s.since < 0;
+            break;
+        }
+
+        const bool change = s.active ? under : over;
+        if (!change || timestampMs - s.lastChange < c.debounceMs)
+            continue;
+
+        s.active     = !s.active;
+        s.lastChange = timestampMs;
+        fire(c, device, channel, s.active, seen, timestampMs);
+    }
+}
+
+void RulesEngine::fire(const Compiled &c, const QString &device, const QString &channel,
+                       bool raised, Milli value, qint64 timestampMs)
+{
+    const Alert alert { device, channel, m_rules[c.source].name, c.kind,
+                        raised, value, timestampMs };
+    for (const Sink &sink : m_sinks)
+        sink(alert);
+}
@@ -0,0 +1,114 @@
+#ifndef RULESENGINE_H
+#define RULESENGINE_H
+
+#include <QHash>
+#include <QString>
+
+#include "iotproto/Milli.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  RulesEngine — per-device alert rules evaluated on every incoming sample.
+//
+//  Three kinds of rule:
+//    • Threshold     value >= limit
+//    • RateOfChange  dv/dt >= limit (units per second) between samples;
+//                    rising only, a fall never raises it
+//    • Sustained     value >= limit continuously for at least windowMs
+//  A raised rule clears once the condition falls clearBand below the limit
+//  (hysteresis), and no rule changes state more often than once per
+//  debounceMs, so a reading hovering at the limit does not flap.
+//
+//  setRules() compiles the rule list into one flat array grouped by
+//  channel; a sample costs one hash lookup for its channel's slice, one for
+//  the device's state array, and a tight loop over the matching rules.
+//  Every raise/clear is fanned out to all subscribed sinks.
+// ─────────────────────────────────────────────────────────────────────────────
+class RulesEngine
+{
+public:
+    enum class Kind : uint8_t { Threshold, RateOfChange, Sustained };
+
+    struct Rule
+    {
+        QString name;
+        QString channel;            // empty = the device's primary channel
+        Kind    kind       = Kind::Threshold;
+        Milli   limit;
+        Milli   clearBand;
+        qint64  windowMs   = 0;     // Sustained only
+        qint64  debounceMs = 0;
+    };
+
+    struct Alert
+    {
+        QString device;
+        QString channel;
+        QString rule;
+        Kind    kind;
+        bool    raised;             // false = cleared
+        Milli   value;              // reading (or rate) that changed the state
+        qint64  timestampMs;
+    };
+
+    using Sink = std::function<void(const Alert &)>;
+
+    /** Replaces the rule set. Per-device state is reset.               */
+    void setRules(const std::vector<Rule> &rules);
+
+    /** Changes the limit of every rule called `name` in place, keeping
+     *  per-device state (e.g. the threshold slider).                   */
+    void setLimit(const QString &name, Milli limit);
+
+    void subscribe(Sink sink) { m_sinks.push_back(std::move(sink)); }
+
+    /** Runs every rule on `channel` — and, if `primary`, every rule on
+     *  the primary channel — against one sample of `device`.           */
+    void evaluate(const QString &device, const QString &channel, bool primary,
+                  qint64 timestampMs, Milli value);
+
+    /** Whether rule `name` is currently raised for `device`.           */
+    bool isActive(const QString &device, const QString &name) const;
+
+private:
+    struct Compiled
+    {
+        Kind    kind;
+        Milli   limit;
+        Milli   clearBand;
+        qint64  windowMs;
+        qint64  debounceMs;
+        int     source;             // index into m_rules
+    };
+
+    struct State
+    {
+        bool    active     = false;
+        bool    hasPrev    = false;
+        qint64  since      = -1;    // Sustained: start of the current run
+        qint64  lastChange = 0;
+        qint64  prevTs     = 0;     // RateOfChange: previous sample
+        Milli   prevValue;
+    };
+
+    using Range = std::pair<int, int>;        // [first, last) in m_compiled
+
+    void run(const Range &range, std::vector<State> &states,
+             const QString &device, const QString &channel,
+             qint64 timestampMs, Milli value);
+    void fire(const Compiled &c, const QString &device, const QString &channel,
+              bool raised, Milli value, qint64 timestampMs);
+
+    std::vector<Rule>              m_rules;
+    std::vector<Compiled>          m_compiled;   // grouped by channel
+    QHash<QString, Range>          m_byChannel;
+    Range                          m_primary {0, 0};
+    QHash<QString, std::vector<State>> m_states; // device -> one per compiled rule
+    std::vector<Sink>              m_sinks;
+};
+
+#endif // RULESENGINE_H
@@ -0,0 +1,387 @@
+#include "seriesstore.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Bit stream helpers — MSB-first within 64-bit words
+// ─────────────────────────────────────────────────────────────────────────────
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint64_t> &words) : m_words(words) {}
+
+    // n in [1, 64]
+    void write(uint64_t v, unsigned n)
+    {
+        if (n < 64)
+            v &= (uint64_t(1) << n) - 1;
+        const unsigned used = static_cast<unsigned>(m_bits % 64);
+        if (used == 0)
+            m_words.push_back(0);
+        const unsigned room = 64 - used;
+        if (n <= room) {
+            m_words.back() |= v << (room - n);
+        } else {
+            const unsigned rest = n - room;
+            m_words.back() |= v >> rest;
+            m_words.push_back(v << (64 - rest));
+        }
+        m_bits += n;
+    }
+
+private:
+    std::vector<uint64_t> &m_words;
+    std::size_t            m_bits = 0;
+};
+
+class BitReader
+{
+public:
+    explicit BitReader(const std::vector<uint64_t> &words) : m_words(words) {}
+
+    // n in [1, 64]
+    uint64_t read(unsigned n)
+    {
+        const std::size_t word  = m_pos / 64;
+        const unsigned    used  = static_cast<unsigned>(m_pos % 64);
+        const unsigned    avail = 64 - used;
+        uint64_t r = (m_words[word] << used) >> (64 - n);
+        if (n > avail)
+            r |= m_words[word + 1] >> (64 - (n - avail));
+        m_pos += n;
+        return r;
+    }
+
+    bool bit() { return read(1) != 0; }
+
+private:
+    const std::vector<uint64_t> &m_words;
+    std::size_t                  m_pos = 0;
+};
+
+uint64_t zigzag(int64_t v)   { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t  unzigzag(uint64_t v){ return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Prefix-coded buckets: control prefix, payload width. A zero is the
+// single bit '0'; each bucket's prefix is one more '1' than the last and
+// the final one, with no terminating '0', takes anything.
+struct Bucket { uint64_t prefix; unsigned prefixBits; unsigned payloadBits; };
+constexpr Bucket kDodBuckets[] = {          // timestamp delta-of-delta
+    { 0b10,   2,  7 },
+    { 0b110,  3,  9 },
+    { 0b1110, 4, 12 },
+    { 0b1111, 4, 64 },
+};
+constexpr Bucket kValueBuckets[] = {        // value delta, in thousandths
+    { 0b10,   2,  6 },
+    { 0b110,  3, 10 },
+    { 0b1110, 4, 16 },
+    { 0b1111, 4, 64 },
+};
+
+template <std::size_t N>
+void writeBucketed(BitWriter &w, uint64_t zz, const Bucket (&buckets)[N])
+{
+    if (zz == 0) {
+        w.write(0, 1);
+        return;
+    }
+    for (const Bucket &b : buckets) {
+        if (b.payloadBits == 64 || zz < (uint64_t(1) << b.payloadBits)) {
+            w.write(b.prefix, b.prefixBits);
+            w.write(zz, b.payloadBits);
+            return;
+        }
+    }
+}
+
+template <std::size_t N>
+int64_t readBucketed(BitReader &r, const Bucket (&buckets)[N])
+{
+    if (!r.bit())
+        return 0;
+    for (const Bucket &b : buckets) {
+        if (b.payloadBits == 64 || !r.bit())
+            return unzigzag(r.read(b.payloadBits));
+    }
+    return 0;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Chunk codec
+// ─────────────────────────────────────────────────────────────────────────────
+SeriesStore::Chunk SeriesStore::encode(const qint64 *ts, const Milli *values,
+                                       std::size_t n)
+{
+    Chunk c;
+    c.firstTs   = ts[0];
+    c.lastTs    = ts[n - 1];
+    c.lastValue = values[n - 1];
+    c.count     = static_cast<std::uint32_t>(n);
+
+    BitWriter w(c.bits);
+    w.write(static_cast<uint32_t>(values[0].raw), 32);
+
+    qint64  prevTs    = ts[0];
+    qint64  prevDelta = 0;
+    int64_t prevV     = values[0].raw;
+
+    for (std::size_t i = 1; i < n; ++i) {
+        const qint64 delta = ts[i] - prevTs;
+        writeBucketed(w, zigzag(delta - prevDelta), kDodBuckets);
+        prevDelta = delta;
+        prevTs    = ts[i];
+
+        writeBucketed(w, zigzag(values[i].raw - prevV), kValueBuckets);
+        prevV = values[i].raw;
+    }
+
+    c.bits.shrink_to_fit();
+    return c;
+}
+
+void SeriesStore::decode(const Chunk &c, std::vector<qint64> &ts,
+                         std::vector<Milli> &values)
+{
+    if (c.count == 0)
+        return;
+
+    ts.reserve(ts.size() + c.count);
+    values.reserve(values.size() + c.count);
+
+    BitReader r(c.bits);
+    int64_t prevV = static_cast<int32_t>(r.read(32));
+    ts.push_back(c.firstTs);
+    values.push_back(Milli::fromRaw(static_cast<int32_t>(prevV)));
+
+    qint64 prevTs    = c.firstTs;
+    qint64 prevDelta = 0;
+
+    for (std::uint32_t i = 1; i < c.count; ++i) {
+        prevDelta += readBucketed(r, kDodBuckets);
+        prevTs    += prevDelta;
+        ts.push_back(prevTs);
+
+        prevV += readBucketed(r, kValueBuckets);
+        values.push_back(Milli::fromRaw(static_cast<int32_t>(prevV)));
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Writes
+// ─────────────────────────────────────────────────────────────────────────────
+void SeriesStore::append(const QString &device, const QString &channel,
+                         qint64 timestampMs, Milli value)
+{
+    Series &s = m_devices[device][channel];
+
+    qint64 newest = std::numeric_limits<qint64>::min();
+    if (!s.headTs.empty())
+        newest = s.headTs.back();
+    else if (!s.sealed.empty())
+        newest = s.sealed.back().lastTs;
+
+    if (timestampMs >= newest) {
+        s.headTs.push_back(timestampMs);
+        s.headValues.push_back(value);
+    } else {
+        // Replayed batches can arrive after live readings.
+        insertLate(s, timestampMs, value);
+    }
+    ++s.total;
+
+    if (s.headTs.size() >= kChunkPoints)
+        seal(s);
+    trim(s);
+}
+
+void SeriesStore::insertLate(Series &s, qint64 timestampMs, Milli value)
+{
+    // Nothing sealed yet (the first kChunkPoints of a series, e.g. a replay
+    // right after a server restart): the open chunk takes it, even if it
+    // predates everything there.
+    if (s.sealed.empty() || (!s.headTs.empty() && timestampMs >= s.headTs.front())) {
+        const auto it = std::upper_bound(s.headTs.begin(), s.headTs.end(), timestampMs);
+        const auto at = it - s.headTs.begin();
+        s.headTs.insert(it, timestampMs);
+        s.headValues.insert(s.headValues.begin() + at, value);
+        return;
+    }
+
+    // Belongs to a sealed chunk: the last one starting at or before it, or
+    // the first one if it predates everything. Re-encode just that chunk.
+    auto it = std::upper_bound(s.sealed.begin(), s.sealed.end(), timestampMs,
+                               [](qint64 t, const Chunk &c) { return t < c.firstTs; });
+    if (it != s.sealed.begin())
+        --it;
+
+    std::vector<qint64> ts;
+    std::vector<Milli> values;
+    decode(*it, ts, values);
+    const auto pos = std::upper_bound(ts.begin(), ts.end(), timestampMs) - ts.begin();
+    ts.insert(ts.begin() + pos, timestampMs);
+    values.insert(values.begin() + pos, value);
+
+    if (ts.size() < 2 * kChunkPoints) {
+        *it = encode(ts.data(), values.data(), ts.size());
+    } else {
+        const std::size_t half = ts.size() / 2;
+        *it = encode(ts.data(), values.data(), half);
+        s.sealed.insert(it + 1, encode(ts.data() + half, values.data() + half,
+                                       ts.size() - half));
+    }
+}
+
+void SeriesStore::seal(Series &s)
+{
+    s.sealed.push_back(encode(s.headTs.data(), s.headValues.data(), s.headTs.size()));
+    s.headTs.clear();
+    s.headValues.clear();
+}
+
+// Retention drops whole chunks from the front, never a partial one.
+void SeriesStore::trim(Series &s)
+{
+    if (m_retention == 0)
+        return;
+    std::size_t drop = 0;
+    while (drop < s.sealed.size() && s.total - s.sealed[drop].count >= m_retention) {
+        s.total -= s.sealed[drop].count;
+        ++drop;
+    }
+    if (drop > 0)
+        s.sealed.erase(s.sealed.begin(), s.sealed.begin() + static_cast<std::ptrdiff_t>(drop));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Reads
+// ─────────────────────────────────────────────────────────────────────────────
+const SeriesStore::Series *SeriesStore::find(const QString &device,
+                                             const QString &channel) const
+{
+    const auto dev = m_devices.constFind(device);
+    if (dev == m_devices.constEnd())
+        return nullptr;
+    const auto ch = dev->constFind(channel);
+    return ch == dev->constEnd() ? nullptr : &ch.value();
+}
+
+Milli SeriesStore::latest(const QString &device, const QString &channel,
+                          Milli fallback) const
+{
+    const Series *s = find(device, channel);
+    if (!s)
+        return fallback;
+    if (!s->headValues.empty())
+        return s->headValues.back();
+    return s->sealed.empty() ? fallback : s->sealed.back().lastValue;
+}
+
+std::size_t SeriesStore::query(const QString &device, const QString &channel,
+                               qint64 fromMs, qint64 toMs,
+                               std::vector<qint64> &timestamps,
+                               std::vector<Milli> &values) const
+{
+    const Series *s = find(device, channel);
+    if (!s || fromMs > toMs)
+        return 0;
+
+    const std::size_t before = timestamps.size();
+    std::vector<qint64> ts;
+    std::vector<Milli> vs;
+
+    for (const Chunk &c : s->sealed) {
+        if (c.lastTs < fromMs)
+            continue;
+        if (c.firstTs > toMs)
+            break;
+        if (c.firstTs >= fromMs && c.lastTs <= toMs) {
+            decode(c, timestamps, values);
+            continue;
+        }
+        ts.clear();
+        vs.clear();
+        decode(c, ts, vs);
+        const auto lo = std::lower_bound(ts.begin(), ts.end(), fromMs) - ts.begin();
+        const auto hi = std::upper_bound(ts.begin(), ts.end(), toMs)   - ts.begin();
+        timestamps.insert(timestamps.end(), ts.begin() + lo, ts.begin() + hi);
+        values.insert(values.end(), vs.begin() + lo, vs.begin() + hi);
+    }
+
+    const auto lo = std::lower_bound(s->headTs.begin(), s->headTs.end(), fromMs) - s->headTs.begin();
+    const auto hi = std::upper_bound(s->headTs.begin(), s->headTs.end(), toMs)   - s->headTs.begin();
+    timestamps.insert(timestamps.end(), s->headTs.begin() + lo, s->headTs.begin() + hi);
+    values.insert(values.end(), s->headValues.begin() + lo, s->headValues.begin() + hi);
+
+    return timestamps.size() - before;
+}
+
+std::size_t SeriesStore::tail(const QString &device, const QString &channel,
+                              std::size_t n,
+                              std::vector<qint64> &timestamps,
+                              std::vector<Milli> &values) const
+{
+    const Series *s = find(device, channel);
+    if (!s || n == 0)
+        return 0;
+
+    // Walk back over just enough sealed chunks to cover n samples.
+    std::size_t need  = n > s->headTs.size() ? n - s->headTs.size() : 0;
+    std::size_t first = s->sealed.size();
+    while (need > 0 && first > 0) {
+        --first;
+        need -= std::min<std::size_t>(need, s->sealed[first].count);
+    }
+
+    std::vector<qint64> ts;
+    std::vector<Milli> vs;
+    for (std::size_t i = first; i < s->sealed.size(); ++i)
+        decode(s->sealed[i], ts, vs);
+    ts.insert(ts.end(), s->headTs.begin(), s->headTs.end());
+    vs.insert(vs.end(), s->headValues.begin(), s->headValues.end());
+
+    const std::size_t take = std::min(n, ts.size());
+    timestamps.insert(timestamps.end(), ts.end() - static_cast<std::ptrdiff_t>(take), ts.end());
+    values.insert(values.end(), vs.end() - static_cast<std::ptrdiff_t>(take), vs.end());
+    return take;
+}
+
+std::size_t SeriesStore::size(const QString &device, const QString &channel) const
+{
+    const Series *s = find(device, channel);
+    return s ? s->total : 0;
+}
+
+std::size_t SeriesStore::memoryBytes() const
+{
+    std::size_t bytes = 0;
+    for (const auto &dev : m_devices) {
+        for (const Series &s : dev) {
+            bytes += s.sealed.capacity() * sizeof(Chunk);
+            for (const Chunk &c : s.sealed)
+                bytes += c.bits.capacity() * sizeof(uint64_t);
+            bytes += s.headTs.capacity() * sizeof(qint64)
+                   + s.headValues.capacity() * sizeof(Milli);
+        }
+    }
+    return bytes;
+}
+
+QStringList SeriesStore::devices() const
+{
+    QStringList out = m_devices.keys();
+    out.sort();
+    return out;
+}
+
+QStringList SeriesStore::channels(const QString &device) const
+{
+    QStringList out = m_devices.value(device).keys();
+    out.sort();
+    return out;
+}
@@ -0,0 +1,101 @@
+#ifndef SERIESSTORE_H
+#define SERIESSTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "iotproto/Milli.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  SeriesStore — every reading the server has seen, per device and channel.
+//
+//  Each (device, channel) series is a run of fixed-size chunks. The newest
+//  chunk is open: two plain arrays, one of timestamps and one of values.
+//  Once it holds kChunkPoints samples it is sealed into a compressed bit
+//  stream (Gorilla-style):
+//    • timestamps as delta-of-delta, so a steady sampling rate costs ~1 bit
+//    • values (Milli, so exact integers) as the zigzag'd difference from
+//      their predecessor, in the same prefix-coded buckets: an unchanged
+//      reading costs 1 bit, a step of up to ±31 m°C costs 8
+//  A slowly moving temperature ends up at about two bytes per sample, so
+//  a million samples fit in a couple of MB. Range queries decode chunk by chunk
+//  into column arrays, skipping every chunk outside the range.
+// ─────────────────────────────────────────────────────────────────────────────
+class SeriesStore
+{
+public:
+    /** Samples per chunk; also the granularity of retention trimming.   */
+    static constexpr std::size_t kChunkPoints = 1024;
+
+    /** Points kept per series before whole chunks are dropped.          */
+    static constexpr std::size_t kDefaultRetention = 4 * 1024 * 1024;
+
+    void append(const QString &device, const QString &channel,
+                qint64 timestampMs, Milli value);
+
+    /** Newest value of a series, or `fallback` if it has none.          */
+    Milli latest(const QString &device, const QString &channel,
+                 Milli fallback = Milli()) const;
+
+    /** Appends every sample with fromMs <= t <= toMs to the two output
+     *  columns, in time order. Returns the number appended.            */
+    std::size_t query(const QString &device, const QString &channel,
+                      qint64 fromMs, qint64 toMs,
+                      std::vector<qint64> &timestamps,
+                      std::vector<Milli> &values) const;
+
+    /** The newest `n` samples (fewer if the series is shorter).         */
+    std::size_t tail(const QString &device, const QString &channel,
+                     std::size_t n,
+                     std::vector<qint64> &timestamps,
+                     std::vector<Milli> &values) const;
+
+    /** Number of samples currently held for a series.                   */
+    std::size_t size(const QString &device, const QString &channel) const;
+
+    /** Heap bytes used by sample data across all series (approximate). */
+    std::size_t memoryBytes() const;
+
+    QStringList devices() const;
+    QStringList channels(const QString &device) const;
+
+    void setRetention(std::size_t points) { m_retention = points; }
+
+private:
+    struct Chunk
+    {
+        qint64                firstTs   = 0;
+        qint64                lastTs    = 0;
+        Milli                 lastValue;
+        std::uint32_t         count     = 0;
+        std::vector<uint64_t> bits;           // MSB-first bit stream
+    };
+
+    struct Series
+    {
+        std::vector<Chunk>  sealed;           // ascending, non-overlapping
+        std::vector<qint64> headTs;           // open chunk, ascending
+        std::vector<Milli>  headValues;
+        std::size_t         total = 0;
+    };
+
+    static Chunk encode(const qint64 *ts, const Milli *values, std::size_t n);
+    static void  decode(const Chunk &chunk, std::vector<qint64> &ts,
+                        std::vector<Milli> &values);
+
+    void insertLate(Series &s, qint64 timestampMs, Milli value);
+    void seal(Series &s);
+    void trim(Series &s);
+
+    const Series *find(const QString &device, const QString &channel) const;
+
+    QHash<QString, QHash<QString, Series>> m_devices;
+    std::size_t m_retention = kDefaultRetention;
+};
+
+#endif // SERIESSTORE_H
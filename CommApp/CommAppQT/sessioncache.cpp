@@ -0,0 +1,66 @@
+#include "sessioncache.h"
+
+#include <QRandomGenerator>
+
+#include <charconv>
+
+quint64 SessionCache::create(qint64 nowMs)
+{
+    expire(nowMs);
+
+    // Still full after expiry: drop whoever has been away the longest.
+    if (m_sessions.size() >= m_capacity && !m_sessions.isEmpty()) {
+        auto oldest = m_sessions.begin();
+        for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it)
+            if (it->lastSeenMs < oldest->lastSeenMs)
+                oldest = it;
+        m_sessions.erase(oldest);
+    }
+
+    quint64 token;
+    do {
+        token = QRandomGenerator::system()->generate64();
+    } while (token == 0 || m_sessions.contains(token));
+
+    Session &s   = m_sessions[token];
+    s.lastSeenMs = nowMs;
+    return token;
+}
+
+SessionCache::Session *SessionCache::find(quint64 token, qint64 nowMs)
+{
+    auto it = m_sessions.find(token);
+    if (it == m_sessions.end())
+        return nullptr;
+    if (nowMs - it->lastSeenMs > m_ttlMs) {
+        m_sessions.erase(it);
+        return nullptr;
+    }
+    it->lastSeenMs = nowMs;
+    return &it.value();
+}
+
+void SessionCache::expire(qint64 nowMs)
+{
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        if (nowMs - it->lastSeenMs > m_ttlMs)
+            it = m_sessions.erase(it);
+        else
+            ++it;
+    }
+}
+
+QString SessionCache::formatToken(quint64 token)
+{
+    return QString("%1").arg(token, 16, 16, QChar('0'));
+}
+
+quint64 SessionCache::parseToken(std::string_view text)
+{
+    quint64 token = 0;
+    const char *end = text.data() + text.size();
+    auto [ptr, ec]  = std::from_chars(text.data(), end, token, 16);
+    if (text.empty() || ec != std::errc() || ptr != end)
+        return 0;
+    return token;
+}
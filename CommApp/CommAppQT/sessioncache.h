@@ -0,0 +1,62 @@
+#ifndef SESSIONCACHE_H
+#define SESSIONCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "iotproto/Milli.h"
+
+#include <string_view>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  SessionCache — what the server remembers about a stream client between
+//  connections, keyed by the token it handed out in "session <token> <n>".
+//
+//  A client that reconnects with "resume <token>" gets its device id,
+//  channel layout and push mode back without re-announcing them, is only
+//  sent the threshold if it changed while the client was away, and learns
+//  how many spooled readings the server already holds so it does not
+//  replay them twice. Entries expire ttlMs after they were last touched;
+//  a full cache evicts the least recently touched one. Tokens are random
+//  64-bit values, so a token from before a server restart is simply
+//  unknown and the client starts over.
+// ─────────────────────────────────────────────────────────────────────────────
+class SessionCache
+{
+public:
+    struct Session
+    {
+        QString     deviceId;
+        QStringList channelNames;
+        Milli       threshold;              // last value the device accepted
+        bool        pushes      = false;    // device sent "mode push"
+        quint64     records     = 0;        // "batch" items received
+        qint64      lastSeenMs  = 0;
+    };
+
+    explicit SessionCache(int capacity = 1024, qint64 ttlMs = 15 * 60 * 1000)
+        : m_capacity(capacity), m_ttlMs(ttlMs) {}
+
+    /** Starts a session and returns its token (never 0).              */
+    quint64 create(qint64 nowMs);
+
+    /** The live session for `token`, touched; nullptr if unknown or
+     *  expired. The pointer is valid until the next create().          */
+    Session *find(quint64 token, qint64 nowMs);
+
+    int size() const { return static_cast<int>(m_sessions.size()); }
+
+    static QString formatToken(quint64 token);
+    /** 0 if `text` is not a token.                                     */
+    static quint64 parseToken(std::string_view text);
+
+private:
+    void expire(qint64 nowMs);
+
+    int                       m_capacity;
+    qint64                    m_ttlMs;
+    QHash<quint64, Session>   m_sessions;
+};
+
+#endif // SESSIONCACHE_H
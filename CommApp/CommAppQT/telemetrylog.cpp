@@ -0,0 +1,444 @@
+#include "telemetrylog.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QtGlobal>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint64_t kMagic       = 0x31474F4C544F49ULL;   // "IOTLOG1"
+constexpr uint32_t kVersion     = 2;     // 1: values were doubles
+constexpr off_t    kHeaderBytes = 64;
+constexpr qint64   kRetentionMs = 30LL * 24 * 3600 * 1000;
+
+struct SegmentHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    char     reserved[kHeaderBytes - 16];
+};
+static_assert(sizeof(SegmentHeader) == kHeaderBytes, "segment header layout");
+
+bool writeAll(int fd, const void *data, std::size_t len)
+{
+    const char *p = static_cast<const char *>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p   += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// A v1 record's double sits where v2 keeps value and unused.
+Milli TelemetryLog::recordValue(const Record &r, uint32_t version)
+{
+    if (version >= 2)
+        return Milli::fromRaw(r.value);
+    double v;
+    std::memcpy(&v, reinterpret_cast<const char *>(&r) + offsetof(Record, value), sizeof(v));
+    return Milli::fromDouble(v);
+}
+
+TelemetryLog::~TelemetryLog()
+{
+    close();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Record checksum — FNV-1a over everything but the checksum itself
+// ─────────────────────────────────────────────────────────────────────────────
+uint32_t TelemetryLog::checksum(const Record &r)
+{
+    const auto *p = reinterpret_cast<const unsigned char *>(&r);
+    uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < offsetof(Record, check); ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void TelemetryLog::extendIndex(std::vector<IndexEntry> &index, const Record *recs,
+                               std::size_t n, uint64_t firstRecord)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        const qint64 t = recs[i].timestampMs;
+        if (index.empty() || index.back().count >= kIndexStride) {
+            index.push_back({t, t, firstRecord + i, 0});
+        }
+        IndexEntry &e = index.back();
+        e.minTs = std::min(e.minTs, t);
+        e.maxTs = std::max(e.maxTs, t);
+        ++e.count;
+    }
+}
+
+QString TelemetryLog::segmentPath(uint32_t seq, const char *suffix) const
+{
+    return QString("%1/segment-%2.%3").arg(m_dir).arg(seq, 8, 10, QChar('0')).arg(suffix);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  open / close
+// ─────────────────────────────────────────────────────────────────────────────
+bool TelemetryLog::open(const QString &dir)
+{
+    close();
+    m_dir = dir;
+    if (!QDir().mkpath(m_dir)) {
+        qWarning("[TelemetryLog] cannot create %s", qPrintable(m_dir));
+        return false;
+    }
+
+    loadCatalog();
+
+    QStringList files = QDir(m_dir).entryList({"segment-*.log"}, QDir::Files, QDir::Name);
+    static const QRegularExpression re("^segment-(\\d{8})\\.log$");
+    std::vector<uint32_t> seqs;
+    for (const QString &f : files) {
+        const auto m = re.match(f);
+        if (m.hasMatch()) seqs.push_back(m.captured(1).toUInt());
+    }
+    std::sort(seqs.begin(), seqs.end());
+
+    m_segments.clear();
+    const qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - kRetentionMs;
+
+    for (std::size_t i = 0; i < seqs.size(); ++i) {
+        Segment seg;
+        seg.seq = seqs[i];
+        const bool active = (i + 1 == seqs.size());
+
+        // Sealed segments normally come with an index file; the active one
+        // (or any whose index went missing) is rebuilt by a verifying scan.
+        QFile idx(segmentPath(seg.seq, "idx"));
+        if (!active && idx.open(QIODevice::ReadOnly)
+            && idx.size() % static_cast<qint64>(sizeof(IndexEntry)) == 0) {
+            seg.index.resize(static_cast<std::size_t>(idx.size()) / sizeof(IndexEntry));
+            idx.read(reinterpret_cast<char *>(seg.index.data()), idx.size());
+        } else {
+            const int fd = ::open(qPrintable(segmentPath(seg.seq, "log")),
+                                  O_RDWR | O_CLOEXEC);
+            if (fd < 0 || !recoverSegment(seg, fd)) {
+                if (fd >= 0) ::close(fd);
+                qWarning("[TelemetryLog] skipping unreadable segment %u", seg.seq);
+                continue;
+            }
+            ::close(fd);
+        }
+
+        // Whole-segment retention: drop sealed segments entirely older
+        // than the cutoff, never the one being written.
+        qint64 newest = std::numeric_limits<qint64>::min();
+        for (const IndexEntry &e : seg.index) newest = std::max(newest, e.maxTs);
+        if (!active && newest < cutoff) {
+            QFile::remove(segmentPath(seg.seq, "log"));
+            QFile::remove(segmentPath(seg.seq, "idx"));
+            continue;
+        }
+        m_segments.push_back(std::move(seg));
+    }
+
+    // Keep appending to the newest segment if it survived recovery and is
+    // of the current version; otherwise start a fresh one rather than
+    // reopen a sealed segment or mix record layouts.
+    bool ok;
+    if (!m_segments.empty() && m_segments.back().seq == seqs.back()
+        && m_segments.back().version == kVersion) {
+        ok = openSegment(m_segments.back().seq, false);
+    } else {
+        Segment seg;
+        seg.seq = seqs.empty() ? 1 : seqs.back() + 1;
+        m_segments.push_back(seg);
+        ok = openSegment(seg.seq, true);
+    }
+    m_open = ok;
+    return ok;
+}
+
+void TelemetryLog::close()
+{
+    m_open = false;
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+        m_stop = false;
+    }
+    if (m_segmentFd >= 0) { ::fdatasync(m_segmentFd); ::close(m_segmentFd); m_segmentFd = -1; }
+    if (m_catalogFd >= 0) { ::close(m_catalogFd); m_catalogFd = -1; }
+}
+
+// Validates every record of a segment, truncates a torn tail and rebuilds
+// the sparse index.
+bool TelemetryLog::recoverSegment(Segment &seg, int fd)
+{
+    struct stat st{};
+    if (::fstat(fd, &st) < 0 || st.st_size < kHeaderBytes) return false;
+
+    SegmentHeader hdr{};
+    if (::pread(fd, &hdr, sizeof(hdr), 0) != static_cast<ssize_t>(sizeof(hdr))
+        || hdr.magic != kMagic || hdr.recordSize != sizeof(Record)
+        || hdr.version < 1 || hdr.version > kVersion)
+        return false;
+    seg.version = hdr.version;
+
+    const std::size_t n = static_cast<std::size_t>(st.st_size - kHeaderBytes) / sizeof(Record);
+    std::size_t valid = 0;
+    if (n > 0) {
+        void *map = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) return false;
+        const auto *recs = reinterpret_cast<const Record *>(static_cast<const char *>(map) + kHeaderBytes);
+        while (valid < n && recs[valid].check == checksum(recs[valid])) ++valid;
+        extendIndex(seg.index, recs, valid, 0);
+        ::munmap(map, static_cast<std::size_t>(st.st_size));
+    }
+
+    const off_t good = kHeaderBytes + static_cast<off_t>(valid * sizeof(Record));
+    if (good != st.st_size) {
+        qWarning("[TelemetryLog] segment %u: dropping %lld torn byte(s)",
+                 seg.seq, static_cast<long long>(st.st_size - good));
+        if (::ftruncate(fd, good) < 0) return false;
+    }
+    return true;
+}
+
+bool TelemetryLog::openSegment(uint32_t seq, bool create)
+{
+    const int flags = O_WRONLY | O_APPEND | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    m_segmentFd = ::open(qPrintable(segmentPath(seq, "log")), flags, 0644);
+    if (m_segmentFd < 0) {
+        qWarning("[TelemetryLog] cannot open segment %u: %s", seq, strerror(errno));
+        return false;
+    }
+    m_records = 0;
+    for (const IndexEntry &e : m_segments.back().index) m_records += e.count;
+
+    if (create) {
+        m_segments.back().version = kVersion;
+        SegmentHeader hdr{};
+        hdr.magic      = kMagic;
+        hdr.version    = kVersion;
+        hdr.recordSize = sizeof(Record);
+        if (!writeAll(m_segmentFd, &hdr, sizeof(hdr))) {
+            ::close(m_segmentFd);
+            m_segmentFd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writer thread: persist the index of the full segment, start the next.
+void TelemetryLog::sealSegment()
+{
+    Segment &done = m_segments.back();
+    ::fdatasync(m_segmentFd);
+    ::close(m_segmentFd);
+    m_segmentFd = -1;
+
+    QFile idx(segmentPath(done.seq, "idx.tmp"));
+    if (idx.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        idx.write(reinterpret_cast<const char *>(done.index.data()),
+                  static_cast<qint64>(done.index.size() * sizeof(IndexEntry)));
+        idx.close();
+        QFile::remove(segmentPath(done.seq, "idx"));
+        idx.rename(segmentPath(done.seq, "idx"));
+    }
+
+    Segment next;
+    next.seq = done.seq + 1;
+    m_segments.push_back(next);
+    openSegment(next.seq, true);
+}
+
+void TelemetryLog::loadCatalog()
+{
+    m_seriesIds.clear();
+    m_seriesNames.clear();
+
+    const QString path = m_dir + "/series.map";
+    QFile f(path);
+    QByteArray data;
+    if (f.open(QIODevice::ReadOnly)) data = f.readAll();
+    f.close();
+
+    // A line without its '\n' was cut short by a crash; drop it.
+    const qsizetype end = data.lastIndexOf('\n') + 1;
+    if (end != data.size()) {
+        data.truncate(end);
+        if (::truncate(qPrintable(path), end) < 0)
+            qWarning("[TelemetryLog] cannot repair %s", qPrintable(path));
+    }
+
+    for (const QByteArray &line : data.split('\n')) {
+        const QList<QByteArray> parts = line.split('\t');
+        if (parts.size() != 3) continue;
+        bool ok = false;
+        const uint32_t id = parts[0].toUInt(&ok);
+        if (!ok) continue;
+        const QString device  = QString::fromUtf8(parts[1]);
+        const QString channel = QString::fromUtf8(parts[2]);
+        if (m_seriesNames.size() <= id) m_seriesNames.resize(id + 1);
+        m_seriesNames[id] = {device, channel};
+        m_seriesIds.insert(device + '\t' + channel, id);
+    }
+
+    m_catalogFd = ::open(qPrintable(path), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Write path
+// ─────────────────────────────────────────────────────────────────────────────
+void TelemetryLog::append(const QString &device, const QString &channel,
+                          qint64 timestampMs, Milli value)
+{
+    if (!isOpen()) return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const QString key = device + '\t' + channel;
+    auto it = m_seriesIds.constFind(key);
+    uint32_t id;
+    if (it != m_seriesIds.constEnd()) {
+        id = it.value();
+    } else {
+        id = static_cast<uint32_t>(m_seriesNames.size());
+        m_seriesNames.push_back({device, channel});
+        m_seriesIds.insert(key, id);
+        m_pendingCatalog += QString("%1\t%2\n").arg(id).arg(key).toStdString();
+    }
+
+    Record r{timestampMs, value.raw, 0, id, 0};
+    r.check = checksum(r);
+    m_pending.push_back(r);
+
+    if (!m_writer.joinable())
+        m_writer = std::thread([this] { writerLoop(); });
+    if (m_pending.size() >= kGroupRecords) {
+        lock.unlock();
+        m_wake.notify_one();
+    }
+}
+
+void TelemetryLog::writerLoop()
+{
+    std::vector<Record> batch;
+    std::string         catalog;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs),
+                        [this] { return m_stop || m_pending.size() >= kGroupRecords; });
+        if (m_pending.empty() && m_pendingCatalog.empty()) {
+            if (m_stop) break;
+            continue;
+        }
+        batch.swap(m_pending);
+        catalog.swap(m_pendingCatalog);
+        lock.unlock();
+
+        writeBatch(batch, catalog);
+        batch.clear();
+        catalog.clear();
+
+        lock.lock();
+    }
+}
+
+// One group commit: new series names first (records must never reference
+// an id the catalog does not have), then the records, one sync each.
+void TelemetryLog::writeBatch(std::vector<Record> &records, std::string &catalog)
+{
+    if (!catalog.empty() && m_catalogFd >= 0) {
+        if (!writeAll(m_catalogFd, catalog.data(), catalog.size()))
+            qWarning("[TelemetryLog] catalog write failed: %s", strerror(errno));
+        ::fdatasync(m_catalogFd);
+    }
+
+    const std::size_t perSegment = (kSegmentBytes - kHeaderBytes) / sizeof(Record);
+    std::size_t done = 0;
+    while (done < records.size() && m_segmentFd >= 0) {
+        if (m_records >= perSegment) {
+            sealSegment();
+            if (m_segmentFd < 0) break;
+        }
+        const std::size_t n = std::min<std::size_t>(records.size() - done, perSegment - m_records);
+        if (!writeAll(m_segmentFd, records.data() + done, n * sizeof(Record))) {
+            qWarning("[TelemetryLog] segment write failed: %s", strerror(errno));
+            break;
+        }
+        extendIndex(m_segments.back().index, records.data() + done, n, m_records);
+        m_records += n;
+        done      += n;
+    }
+    if (m_segmentFd >= 0)
+        ::fdatasync(m_segmentFd);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Read path
+// ─────────────────────────────────────────────────────────────────────────────
+std::size_t TelemetryLog::load(qint64 fromMs, const Visitor &visit) const
+{
+    std::size_t visited = 0;
+
+    for (const Segment &seg : m_segments) {
+        const bool any = std::any_of(seg.index.begin(), seg.index.end(),
+                                     [fromMs](const IndexEntry &e) { return e.maxTs >= fromMs; });
+        if (!any) continue;
+
+        const int fd = ::open(qPrintable(segmentPath(seg.seq, "log")), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st{};
+        if (::fstat(fd, &st) < 0 || st.st_size <= kHeaderBytes) { ::close(fd); continue; }
+
+        const auto len = static_cast<std::size_t>(st.st_size);
+        void *map = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) continue;
+        ::madvise(map, len, MADV_SEQUENTIAL);
+
+        const auto *hdr  = static_cast<const SegmentHeader *>(map);
+        const auto *recs = reinterpret_cast<const Record *>(static_cast<const char *>(map) + kHeaderBytes);
+        const std::size_t n = (len - kHeaderBytes) / sizeof(Record);
+
+        for (const IndexEntry &e : seg.index) {
+            if (e.maxTs < fromMs) continue;
+            const std::size_t end = std::min<std::size_t>(n, e.first + e.count);
+            for (std::size_t i = e.first; i < end; ++i) {
+                const Record &r = recs[i];
+                if (r.timestampMs < fromMs || r.check != checksum(r)
+                    || r.series >= m_seriesNames.size())
+                    continue;
+                const auto &name = m_seriesNames[r.series];
+                visit(name.first, name.second, r.timestampMs, recordValue(r, hdr->version));
+                ++visited;
+            }
+        }
+        ::munmap(map, len);
+    }
+    return visited;
+}
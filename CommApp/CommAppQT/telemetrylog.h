@@ -0,0 +1,133 @@
+#ifndef TELEMETRYLOG_H
+#define TELEMETRYLOG_H
+
+#include <QHash>
+#include <QString>
+
+#include "iotproto/Milli.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  TelemetryLog — append-only on-disk log of every sample the server sees.
+//
+//  Layout of the log directory:
+//    series.map          "id<TAB>device<TAB>channel" per line, append-only
+//    segment-NNNNNNNN.log 64-byte header + fixed 24-byte records
+//    segment-NNNNNNNN.idx sparse time index of a sealed segment
+//
+//  append() only queues the record; a writer thread drains the queue every
+//  kFlushIntervalMs (or sooner when kGroupRecords pile up) with one write()
+//  and one fdatasync() per batch, so the GUI thread never waits on the disk
+//  and a burst of samples costs one sync instead of one each.
+//
+//  load() maps each segment read-only and uses the sparse index — min/max
+//  timestamp per block of kIndexStride records — to skip whole blocks
+//  outside the requested range. Records carry a checksum; a torn tail
+//  left by a crash is cut off on open. Version 1 segments stored the
+//  value as a double; load() still reads them, converting to Milli, but
+//  new records only ever go to a version 2 segment.
+// ─────────────────────────────────────────────────────────────────────────────
+class TelemetryLog
+{
+public:
+    using Visitor = std::function<void(const QString &device, const QString &channel,
+                                       qint64 timestampMs, Milli value)>;
+
+    static constexpr std::size_t kSegmentBytes    = 64u * 1024 * 1024;
+    static constexpr std::size_t kIndexStride     = 4096;
+    static constexpr std::size_t kGroupRecords    = 1024;
+    static constexpr int         kFlushIntervalMs = 200;
+
+    TelemetryLog() = default;
+    ~TelemetryLog();
+
+    TelemetryLog(const TelemetryLog &)            = delete;
+    TelemetryLog &operator=(const TelemetryLog &) = delete;
+
+    /** Opens (creating if needed) the log in `dir`. Returns false if the
+     *  directory or the active segment cannot be opened.                */
+    bool open(const QString &dir);
+
+    /** Flushes everything queued and stops the writer thread.           */
+    void close();
+
+    bool isOpen() const { return m_open; }
+
+    /** Queues one sample. Thread-safe; never blocks on I/O.             */
+    void append(const QString &device, const QString &channel,
+                qint64 timestampMs, Milli value);
+
+    /** Calls `visit` for every stored sample with t >= fromMs, segment by
+     *  segment. Meant for startup: call it before the first append().
+     *  Returns the number of samples visited.                          */
+    std::size_t load(qint64 fromMs, const Visitor &visit) const;
+
+private:
+    struct Record
+    {
+        qint64   timestampMs;
+        int32_t  value;     // Milli::raw; v1: a double spanning `unused` too
+        uint32_t unused;
+        uint32_t series;
+        uint32_t check;
+    };
+    static_assert(sizeof(Record) == 24, "on-disk record layout");
+
+    struct IndexEntry
+    {
+        qint64   minTs;
+        qint64   maxTs;
+        uint64_t first;     // record number within the segment
+        uint64_t count;
+    };
+
+    struct Segment
+    {
+        uint32_t                seq     = 0;
+        uint32_t                version = 0;    // known once its header is read
+        std::vector<IndexEntry> index;
+    };
+
+    static uint32_t checksum(const Record &r);
+    static Milli    recordValue(const Record &r, uint32_t version);
+    static void     extendIndex(std::vector<IndexEntry> &index, const Record *recs,
+                                std::size_t n, uint64_t firstRecord);
+
+    QString segmentPath(uint32_t seq, const char *suffix) const;
+    bool    openSegment(uint32_t seq, bool create);
+    void    sealSegment();
+    void    loadCatalog();
+    bool    recoverSegment(Segment &seg, int fd);
+
+    void writerLoop();
+    void writeBatch(std::vector<Record> &records, std::string &catalog);
+
+    QString              m_dir;
+    bool                 m_open = false;      // GUI-thread view of isOpen()
+    std::vector<Segment> m_segments;          // ascending seq; last = active
+
+    // Touched only by open()/close() and the writer thread.
+    int      m_segmentFd = -1;
+    int      m_catalogFd = -1;
+    uint64_t m_records   = 0;                 // records in the active segment
+
+    // Series ids; the reverse map is what load() resolves names with.
+    QHash<QString, uint32_t> m_seriesIds;     // "device\tchannel" -> id
+    std::vector<std::pair<QString, QString>> m_seriesNames;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::vector<Record>     m_pending;
+    std::string             m_pendingCatalog;
+    bool                    m_stop = false;
+    std::thread             m_writer;
+};
+
+#endif // TELEMETRYLOG_H
@@ -0,0 +1,332 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "iotproto/Milli.h"
+#include "iotproto/Protocol.h"
+#include "iotproto/Socket.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+/** Change-only reporting. With deadband > 0 the client pushes a reading only
+ *  when it moved by more than `deadband` since the last one sent, or when
+ *  `heartbeatMs` passed without a report; deadband == 0 keeps the classic
+ *  answer-every-poll behaviour. The LED switches on at the threshold and
+ *  only off again once the reading drops `hysteresis` below it.        */
+struct ReportPolicy
+{
+    Milli deadband;
+    long  heartbeatMs = 60000;
+    Milli hysteresis  = Milli::fromRaw(500);
+
+    bool pushMode() const { return deadband > Milli(); }
+};
+
+/** Terminal output policy. Under systemd stdout goes to the journal, where a
+ *  full-screen redraw per sample turns into several log lines per reading.
+ *  Headless mode (forced with --headless, automatic when stdout is not a
+ *  TTY) prints one "status ..." line instead, at most once per interval. */
+struct DisplayConfig
+{
+    bool headless         = false;
+    long statusIntervalMs = 60000;   // 0 = no periodic status at all
+};
+
+/** Everything the client is configured with, parsed once. The first group
+ *  decides what the connection loop is built from (transport, GPIO, spool,
+ *  sensors); the second is applied to a running loop in place.          */
+struct ClientConfig
+{
+    std::string proto     = "tcp";
+    std::string ip        = "192.168.1.100";
+    int         port      = 0;           // 0 = 8080 for TCP, 8081 for UDP
+    std::string localPath;               // empty = the transport's default
+    int         gpio      = 17;
+    std::string spoolPath = "/var/lib/iot-client/spool.bin";
+    bool        withCpu   = false;
+    TxMode      txMode    = TxMode::LowLatency;
+
+    long          sampleMs    = 1000;
+    ReportPolicy  policy;
+    std::size_t   replayBatch = 512;     // readings per replayed "batch" line
+    DisplayConfig display;
+
+    bool stream() const { return proto == "tcp" || proto == "unix" || proto == "shm"; }
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Settings — one table for the config file, the command line and the
+//  server's "set config". A file line is KEY=VALUE ('#' starts a comment);
+//  the same key in lower case is what "set config" takes, and the flag is
+//  the command-line spelling. Only live settings may be set by the server.
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace config
+{
+
+inline constexpr const char *kDefaultPath = "/etc/iot-client/iot-client.conf";
+
+/** Cap on BATCH_SIZE: a text "batch" item is about twenty bytes and the
+ *  server drops lines over 64 KiB (LineFramer::kMaxLine).             */
+inline constexpr long kMaxReplayBatch = 2048;
+
+inline bool sameKey(std::string_view a, std::string_view b)
+{
+    auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; };
+    return a.size() == b.size()
+        && std::equal(a.begin(), a.end(), b.begin(), [&](char x, char y) { return lower(x) == lower(y); });
+}
+
+inline bool parseLong(std::string_view s, long min, long max, long &out)
+{
+    long v = 0;
+    if (!proto::parseNumber(s, v) || v < min || v > max)
+        return false;
+    out = v;
+    return true;
+}
+
+inline bool parseSwitch(std::string_view s, bool &out)
+{
+    for (std::string_view on : { "1", "yes", "on", "true" })
+    {
+        if (sameKey(s, on))
+        {
+            out = true;
+            return true;
+        }
+    }
+    for (std::string_view off : { "0", "no", "off", "false" })
+    {
+        if (sameKey(s, off))
+        {
+            out = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Setting
+{
+    std::string_view key;       // in the file; lower case in "set config"
+    std::string_view flag;      // on the command line
+    bool             live;      // applied to a running loop in place
+    bool             toggle;    // a bare flag on the command line
+    bool           (*set)(ClientConfig &, std::string_view);
+};
+
+inline constexpr Setting kSettings[] = {
+    { "PROTOCOL", "--proto", false, false, [](ClientConfig &c, std::string_view v) {
+        for (std::string_view p : { "tcp", "udp", "unix", "unix-dgram", "shm" })
+            if (sameKey(v, p))
+                return c.proto = std::string(p), true;
+        return false;
+    } },
+    { "SERVER_IP", "--ip", false, false, [](ClientConfig &c, std::string_view v) {
+        return !v.empty() && (c.ip = std::string(v), true);
+    } },
+    { "SERVER_PORT", "--port", false, false, [](ClientConfig &c, std::string_view v) {
+        long port = 0;
+        return parseLong(v, 0, 65535, port) && (c.port = static_cast<int>(port), true);
+    } },
+    { "SOCKET_PATH", "--path", false, false, [](ClientConfig &c, std::string_view v) {
+        return c.localPath = std::string(v), true;
+    } },
+    { "GPIO", "--gpio", false, false, [](ClientConfig &c, std::string_view v) {
+        long gpio = 0;
+        return parseLong(v, 0, 9999, gpio) && (c.gpio = static_cast<int>(gpio), true);
+    } },
+    { "SPOOL", "--spool", false, false, [](ClientConfig &c, std::string_view v) {
+        return !v.empty() && (c.spoolPath = std::string(v), true);
+    } },
+    { "CPU", "--cpu", false, true, [](ClientConfig &c, std::string_view v) {
+        return parseSwitch(v, c.withCpu);
+    } },
+    { "TX", "--tx", false, false, [](ClientConfig &c, std::string_view v) {
+        if (v != "latency" && v != "bulk")
+            return false;
+        c.txMode = (v == "bulk") ? TxMode::Bulk : TxMode::LowLatency;
+        return true;
+    } },
+    { "SAMPLE_MS", "--sample-ms", true, false, [](ClientConfig &c, std::string_view v) {
+        long ms = 0;
+        return parseLong(v, 10, 3600 * 1000L, ms) && (c.sampleMs = ms, true);
+    } },
+    { "DEADBAND", "--deadband", true, false, [](ClientConfig &c, std::string_view v) {
+        return Milli::parse(proto::trim(v), c.policy.deadband);
+    } },
+    { "HEARTBEAT", "--heartbeat", true, false, [](ClientConfig &c, std::string_view v) {
+        long s = 0;
+        return parseLong(v, 0, 24 * 3600L, s) && (c.policy.heartbeatMs = s * 1000, true);
+    } },
+    { "HYSTERESIS", "--hysteresis", true, false, [](ClientConfig &c, std::string_view v) {
+        Milli h;
+        return Milli::parse(proto::trim(v), h) && (c.policy.hysteresis = std::max(Milli(), h), true);
+    } },
+    { "BATCH_SIZE", "--batch-size", true, false, [](ClientConfig &c, std::string_view v) {
+        long n = 0;
+        return parseLong(v, 1, kMaxReplayBatch, n) && (c.replayBatch = static_cast<std::size_t>(n), true);
+    } },
+    { "HEADLESS", "--headless", true, true, [](ClientConfig &c, std::string_view v) {
+        return parseSwitch(v, c.display.headless);
+    } },
+    { "STATUS_INTERVAL", "--status-interval", true, false, [](ClientConfig &c, std::string_view v) {
+        long s = 0;
+        return parseLong(v, 0, 24 * 3600L, s) && (c.display.statusIntervalMs = s * 1000, true);
+    } },
+};
+
+enum class Status
+{
+    Ok,
+    UnknownKey,
+    BadValue,
+    NotLive         // valid, but only takes effect on a new connection loop
+};
+
+inline const char *describe(Status s)
+{
+    switch (s)
+    {
+    case Status::Ok:         return "ok";
+    case Status::UnknownKey: return "unknown setting";
+    case Status::BadValue:   return "invalid value";
+    case Status::NotLive:    return "not settable at run time";
+    }
+    return "?";
+}
+
+/** Sets `key` (any case) to `value` in `cfg`; with `liveOnly` a setting
+ *  that is not live is refused and `cfg` left alone.                  */
+inline Status set(ClientConfig &cfg, std::string_view key, std::string_view value, bool liveOnly = false)
+{
+    for (const Setting &s : kSettings)
+    {
+        if (!sameKey(s.key, key))
+            continue;
+        if (liveOnly && !s.live)
+            return Status::NotLive;
+        ClientConfig next = cfg;
+        if (!s.set(next, proto::trim(value)))
+            return Status::BadValue;
+        cfg = std::move(next);
+        return Status::Ok;
+    }
+    return Status::UnknownKey;
+}
+
+/** Whether going from `a` to `b` changes a setting that is not live.    */
+inline bool needsRestart(const ClientConfig &a, const ClientConfig &b)
+{
+    return a.proto != b.proto || a.ip != b.ip || a.port != b.port
+        || a.localPath != b.localPath || a.gpio != b.gpio
+        || a.spoolPath != b.spoolPath || a.withCpu != b.withCpu || a.txMode != b.txMode;
+}
+
+/** Reads KEY=VALUE lines into `cfg`. A missing file leaves `cfg` as it
+ *  is; a line that does not parse fails the whole load.             */
+inline bool loadFile(const std::string &path, ClientConfig &cfg)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+        return true;
+
+    std::string text;
+    for (int lineNo = 1; std::getline(in, text); ++lineNo)
+    {
+        std::string_view line = text;
+        line = proto::trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        const std::size_t eq = line.find('=');
+        const Status st = eq == std::string_view::npos
+                              ? Status::BadValue
+                              : set(cfg, proto::trim(line.substr(0, eq)), line.substr(eq + 1));
+        if (st != Status::Ok)
+        {
+            std::cerr << "[Config] " << path << ":" << lineNo << ": " << describe(st)
+                      << ": " << line << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Applies the command-line flags to `cfg`. Unknown options are warned
+ *  about and skipped; a bad value fails.                             */
+inline bool parseArgs(int argc, char **argv, ClientConfig &cfg)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--config" || arg == "--help")
+        {
+            i += arg == "--config";
+            continue;
+        }
+        const Setting *s = nullptr;
+        for (const Setting &candidate : kSettings)
+            if (candidate.flag == arg)
+                s = &candidate;
+        if (!s || (!s->toggle && i + 1 >= argc))
+        {
+            std::cerr << "Ignoring unknown option " << arg << "\n";
+            continue;
+        }
+        const std::string_view value = s->toggle ? std::string_view("1") : std::string_view(argv[++i]);
+        if (!s->set(cfg, value))
+        {
+            std::cerr << "Invalid " << arg.substr(2) << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace config
+
+/** Where the configuration comes from: built-in defaults, then the file
+ *  (--config, default /etc/iot-client/iot-client.conf), then the command
+ *  line, so a flag always wins over the file. load() runs again on every
+ *  reload and starts over from the defaults each time.                 */
+class ConfigSource
+{
+public:
+    ConfigSource(int argc, char **argv) : m_argc(argc), m_argv(argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (arg == "--help")
+                m_help = true;
+            else if (arg == "--config" && i + 1 < argc)
+                m_path = argv[++i];
+        }
+    }
+
+    const std::string &path() const { return m_path; }
+    bool help() const { return m_help; }
+
+    /** Fills `cfg`; false (and `cfg` untouched) if anything is invalid. */
+    bool load(ClientConfig &cfg) const
+    {
+        ClientConfig next;
+        if (!config::loadFile(m_path, next) || !config::parseArgs(m_argc, m_argv, next))
+            return false;
+        cfg = std::move(next);
+        return true;
+    }
+
+private:
+    int         m_argc;
+    char      **m_argv;
+    std::string m_path = config::kDefaultPath;
+    bool        m_help = false;
+};
+
+#endif
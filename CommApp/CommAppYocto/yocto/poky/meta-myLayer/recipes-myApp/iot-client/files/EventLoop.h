@@ -0,0 +1,328 @@
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "iotproto/Reactor.h"
+
+/** timerfd wrapper. The fd becomes readable on expiry; call drain() from the
+ *  callback to acknowledge it.                                          */
+class TimerFd
+{
+public:
+    TimerFd() { m_fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC); }
+    ~TimerFd()
+    {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    TimerFd(const TimerFd &)            = delete;
+    TimerFd &operator=(const TimerFd &) = delete;
+
+    int fd() const { return m_fd; }
+
+    /** First expiry after `firstMs`, then every `intervalMs` (0 = one-shot). */
+    void arm(long firstMs, long intervalMs = 0)
+    {
+        struct itimerspec its{};
+        its.it_value.tv_sec     = firstMs / 1000;
+        its.it_value.tv_nsec    = (firstMs % 1000) * 1000000L;
+        its.it_interval.tv_sec  = intervalMs / 1000;
+        its.it_interval.tv_nsec = (intervalMs % 1000) * 1000000L;
+        if (firstMs == 0)
+            its.it_value.tv_nsec = 1;   // 0 would disarm
+        ::timerfd_settime(m_fd, 0, &its, nullptr);
+    }
+
+    void disarm()
+    {
+        struct itimerspec its{};
+        ::timerfd_settime(m_fd, 0, &its, nullptr);
+    }
+
+    /** Returns the number of expirations since the last drain.         */
+    uint64_t drain()
+    {
+        uint64_t expirations = 0;
+        if (::read(m_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+            return 0;
+        return expirations;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+/** Single-threaded epoll reactor. Every source the client waits on (sockets,
+ *  timers, signals) is a file descriptor registered here with a callback, so
+ *  the process sleeps in exactly one place and wakes only when there is
+ *  work to do. It is also the Reactor the async channel API runs on; its
+ *  one-shot timers share a single timerfd, so thousands of pending
+ *  timeouts cost one fd.                                                  */
+class EventLoop : public Reactor
+{
+public:
+    using Callback = IoCallback;
+
+    EventLoop() { m_epfd = ::epoll_create1(EPOLL_CLOEXEC); }
+    ~EventLoop()
+    {
+        if (m_epfd >= 0)
+            ::close(m_epfd);
+    }
+
+    EventLoop(const EventLoop &)            = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    bool valid() const { return m_epfd >= 0; }
+
+    /** Watch `fd` for `events` (EPOLLIN, EPOLLOUT, ...). Returns false if the
+     *  kernel refused the registration.                                  */
+    bool add(int fd, uint32_t events, Callback cb)
+    {
+        struct epoll_event ev{};
+        ev.events  = events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            std::cerr << "[EventLoop] EPOLL_CTL_ADD failed: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        m_callbacks[fd] = std::move(cb);
+        return true;
+    }
+
+    bool modify(int fd, uint32_t events)
+    {
+        struct epoll_event ev{};
+        ev.events  = events;
+        ev.data.fd = fd;
+        return ::epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev) == 0;
+    }
+
+    /** Stop watching `fd`. Must be called before the fd is closed. Safe to
+     *  call from inside that fd's own callback.                          */
+    void remove(int fd)
+    {
+        ::epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr);
+        m_callbacks.erase(fd);
+    }
+
+    /** Dispatch events until stop() is called from a callback.         */
+    void run()
+    {
+        m_running = true;
+        struct epoll_event events[16];
+        while (m_running)
+        {
+            int n = ::epoll_wait(m_epfd, events, 16, -1);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::cerr << "[EventLoop] epoll_wait failed: " << std::strerror(errno) << "\n";
+                break;
+            }
+            for (int i = 0; i < n && m_running; ++i)
+            {
+                // Look the callback up per event: an earlier callback in this
+                // batch may have removed (and closed) this fd.
+                auto it = m_callbacks.find(events[i].data.fd);
+                if (it == m_callbacks.end())
+                    continue;
+                Callback cb = it->second;
+                cb(events[i].events);
+            }
+        }
+    }
+
+    void stop() { m_running = false; }
+
+    // ── Reactor ──────────────────────────────────────────────────────────────
+    bool watch(int fd, uint32_t events, IoCallback cb) override
+    {
+        auto it = m_callbacks.find(fd);
+        if (it == m_callbacks.end())
+            return add(fd, events, std::move(cb));
+        if (!modify(fd, events))
+            return false;
+        it->second = std::move(cb);
+        return true;
+    }
+
+    void unwatch(int fd) override { remove(fd); }
+
+    TimerId callAfter(long ms, std::function<void()> cb) override
+    {
+        if (m_callbacks.count(m_timerFd.fd()) == 0
+            && !add(m_timerFd.fd(), EPOLLIN, [this](uint32_t) { fireTimers(); }))
+            return 0;
+
+        const TimerKey key { Clock::now() + std::chrono::milliseconds(ms), ++m_lastTimerId };
+        m_timers.emplace(key, std::move(cb));
+        m_timerIds.emplace(key.second, key.first);
+        if (m_timers.begin()->first == key)
+            armTimerFd();
+        return key.second;
+    }
+
+    void cancelTimer(TimerId id) override
+    {
+        auto it = m_timerIds.find(id);
+        if (it == m_timerIds.end())
+            return;
+        m_timers.erase(TimerKey { it->second, id });
+        m_timerIds.erase(it);
+        if (m_timerIds.empty())
+            remove(m_timerFd.fd());
+    }
+
+private:
+    using Clock    = std::chrono::steady_clock;
+    using TimerKey = std::pair<Clock::time_point, TimerId>;   // id breaks ties
+
+    void armTimerFd()
+    {
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+            m_timers.begin()->first.first - Clock::now()).count();
+        m_timerFd.arm(wait > 0 ? static_cast<long>(wait) : 0);
+    }
+
+    /** Runs every due timer. Each is unlinked before its callback, which
+     *  may add or cancel timers itself.                                 */
+    void fireTimers()
+    {
+        m_timerFd.drain();
+        const auto now = Clock::now();
+        while (!m_timers.empty() && m_timers.begin()->first.first <= now)
+        {
+            auto node = m_timers.extract(m_timers.begin());
+            m_timerIds.erase(node.key().second);
+            node.mapped()();
+        }
+        if (m_timers.empty())
+            remove(m_timerFd.fd());
+        else
+            armTimerFd();
+    }
+
+    int  m_epfd    = -1;
+    bool m_running = false;
+    std::unordered_map<int, Callback> m_callbacks;
+
+    TimerFd                                         m_timerFd;
+    std::map<TimerKey, std::function<void()>>       m_timers;
+    std::unordered_map<TimerId, Clock::time_point>  m_timerIds;
+    TimerId                                         m_lastTimerId = 0;
+};
+
+/** signalfd wrapper: blocks the given signals for the calling thread (and
+ *  any thread it spawns later) and delivers them as readable events.   */
+class SignalFd
+{
+public:
+    explicit SignalFd(std::initializer_list<int> signals)
+    {
+        sigemptyset(&m_mask);
+        for (int s : signals)
+            sigaddset(&m_mask, s);
+        ::pthread_sigmask(SIG_BLOCK, &m_mask, nullptr);
+        m_fd = ::signalfd(-1, &m_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    }
+    ~SignalFd()
+    {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    SignalFd(const SignalFd &)            = delete;
+    SignalFd &operator=(const SignalFd &) = delete;
+
+    int fd() const { return m_fd; }
+
+    /** Returns the pending signal number, or 0 if none.                */
+    int read()
+    {
+        struct signalfd_siginfo si{};
+        if (::read(m_fd, &si, sizeof(si)) != sizeof(si))
+            return 0;
+        return static_cast<int>(si.ssi_signo);
+    }
+
+private:
+    int      m_fd = -1;
+    sigset_t m_mask{};
+};
+
+/** inotify wrapper for one file. Its directory is watched rather than the
+ *  file, so an editor that saves by renaming a new file over the old one
+ *  is seen as well. fd() is -1 if the directory cannot be watched.    */
+class FileWatch
+{
+public:
+    explicit FileWatch(const std::string &path)
+    {
+        const std::size_t slash = path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash ? slash : 1);
+        m_name = slash == std::string::npos ? path : path.substr(slash + 1);
+        m_fd   = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd >= 0 && ::inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+    ~FileWatch()
+    {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    FileWatch(const FileWatch &)            = delete;
+    FileWatch &operator=(const FileWatch &) = delete;
+
+    int fd() const { return m_fd; }
+
+    /** Drains the pending events; true if any of them was for the file. */
+    bool changed()
+    {
+        alignas(struct inotify_event) char buf[4096];
+        bool hit = false;
+        ssize_t n;
+        while ((n = ::read(m_fd, buf, sizeof(buf))) > 0)
+        {
+            for (char *p = buf; p < buf + n; )
+            {
+                const auto *ev = reinterpret_cast<const struct inotify_event *>(p);
+                if (ev->len > 0 && m_name == ev->name)
+                    hit = true;
+                p += sizeof(struct inotify_event) + ev->len;
+            }
+        }
+        return hit;
+    }
+
+private:
+    int         m_fd = -1;
+    std::string m_name;
+};
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "SensorRegistry.h"
+#include "SpscQueue.h"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+/** One sampling pass as it travels sensor -> logic -> network. `value` is
+ *  the primary temperature (channels[0]); the LED logic only looks at it.
+ *  `timestampMs` is CLOCK_MONOTONIC: it never jumps when the wall clock
+ *  is set, and the server maps it onto its own clock (Protocol.h).      */
+struct Sample
+{
+    int64_t     timestampMs  = 0;
+    Milli       value;
+    bool        ledOn        = false;
+    std::size_t channelCount = 0;
+    Milli       channels[kMaxChannels] = {};
+};
+
+/** Three-stage client pipeline:
+ *
+ *    sensor thread --q1--> logic/LED thread --q2--> network (event loop)
+ *
+ *  The sensor thread samples on its own timerfd, so a slow send or a slow
+ *  sysfs GPIO write never shifts the next sample. Queues are bounded SPSC
+ *  rings: if a downstream stage stalls, samples are dropped and counted
+ *  rather than back-pressuring the sensor. Each queue has an eventfd the
+ *  producer signals after a push; the network stage registers
+ *  outputFd() with its EventLoop.                                        */
+class SamplePipeline
+{
+public:
+    /** Fills channels/channelCount of the sample it is handed.        */
+    using SensorFn = std::function<void(Sample &)>;
+    using LedFn    = std::function<void(bool on)>;
+
+    static constexpr std::size_t kQueueDepth = 256;
+
+    SamplePipeline(SensorFn sensor, LedFn led, Milli threshold, Milli hysteresis)
+        : m_sensor(std::move(sensor)), m_led(std::move(led)),
+          m_threshold(threshold), m_hysteresis(hysteresis)
+    {
+        m_logicEvt  = ::eventfd(0, EFD_CLOEXEC);
+        m_netEvt    = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_stopEvt   = ::eventfd(0, EFD_CLOEXEC);
+        m_periodEvt = ::eventfd(0, EFD_CLOEXEC);
+    }
+
+    ~SamplePipeline()
+    {
+        stop();
+        for (int fd : {m_logicEvt, m_netEvt, m_stopEvt, m_periodEvt})
+            if (fd >= 0)
+                ::close(fd);
+    }
+
+    SamplePipeline(const SamplePipeline &)            = delete;
+    SamplePipeline &operator=(const SamplePipeline &) = delete;
+
+    void start(long sampleMs)
+    {
+        if (m_sensorThread.joinable())
+            return;
+        m_sampleMs.store(sampleMs, std::memory_order_relaxed);
+        m_sensorThread = std::thread([this] { sensorStage(); });
+        m_logicThread  = std::thread([this] { logicStage(); });
+    }
+
+    void stop()
+    {
+        if (!m_sensorThread.joinable())
+            return;
+        signal(m_stopEvt);
+        m_sensorThread.join();
+        m_logicThread.join();
+    }
+
+    /** Readable whenever the network stage has samples to pop().       */
+    int outputFd() const { return m_netEvt; }
+
+    /** Network stage: acknowledge the wakeup, then pop until false.    */
+    void ackOutput()
+    {
+        uint64_t v;
+        (void)!::read(m_netEvt, &v, sizeof(v));
+    }
+    bool pop(Sample &s) { return m_toNet.pop(s); }
+
+    /** New threshold from the server; the logic stage re-evaluates the LED
+     *  immediately instead of waiting for the next sample.              */
+    void setThreshold(Milli t)
+    {
+        m_threshold.store(t, std::memory_order_relaxed);
+        m_kick.store(true, std::memory_order_release);
+        signal(m_logicEvt);
+    }
+
+    /** New hysteresis from a config reload; applied like setThreshold(). */
+    void setHysteresis(Milli h)
+    {
+        m_hysteresis.store(h, std::memory_order_relaxed);
+        m_kick.store(true, std::memory_order_release);
+        signal(m_logicEvt);
+    }
+
+    /** New sample period; the sensor stage re-arms its timer, taking the
+     *  next sample one new period from now.                            */
+    void setSamplePeriod(long sampleMs)
+    {
+        m_sampleMs.store(sampleMs, std::memory_order_relaxed);
+        signal(m_periodEvt);
+    }
+
+    std::size_t sensorQueueDepth() const { return m_toLogic.depth(); }
+    uint64_t    sensorQueueDrops() const { return m_toLogic.drops(); }
+    std::size_t netQueueDepth()    const { return m_toNet.depth(); }
+    uint64_t    netQueueDrops()    const { return m_toNet.drops(); }
+
+    /** The clock samples are stamped with, in milliseconds.            */
+    static int64_t nowMs()
+    {
+        struct timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+private:
+    static void signal(int fd)
+    {
+        uint64_t one = 1;
+        (void)!::write(fd, &one, sizeof(one));
+    }
+
+    static void armPeriod(int tfd, long firstNs, long sampleMs)
+    {
+        struct itimerspec its{};
+        its.it_value.tv_sec     = firstNs / 1000000000L;
+        its.it_value.tv_nsec    = firstNs % 1000000000L;
+        its.it_interval.tv_sec  = sampleMs / 1000;
+        its.it_interval.tv_nsec = (sampleMs % 1000) * 1000000L;
+        ::timerfd_settime(tfd, 0, &its, nullptr);
+    }
+
+    void sensorStage()
+    {
+        int tfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        long sampleMs = m_sampleMs.load(std::memory_order_relaxed);
+        armPeriod(tfd, 1, sampleMs);   // first sample right away
+
+        struct pollfd fds[3] = {{tfd, POLLIN, 0}, {m_stopEvt, POLLIN, 0}, {m_periodEvt, POLLIN, 0}};
+        for (;;)
+        {
+            if (::poll(fds, 3, -1) < 0)
+                continue;
+            if (fds[1].revents)
+                break;
+            if (fds[2].revents)
+            {
+                uint64_t v;
+                (void)!::read(m_periodEvt, &v, sizeof(v));
+                sampleMs = m_sampleMs.load(std::memory_order_relaxed);
+                armPeriod(tfd, sampleMs * 1000000L, sampleMs);
+                continue;
+            }
+            uint64_t expirations;
+            if (::read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations))
+                continue;
+
+            Sample s;
+            s.timestampMs = nowMs();
+            m_sensor(s);
+            s.value = s.channelCount > 0 ? s.channels[0] : Milli();
+            if (m_toLogic.push(s))
+                signal(m_logicEvt);
+        }
+        ::close(tfd);
+    }
+
+    void logicStage()
+    {
+        struct pollfd fds[2] = {{m_logicEvt, POLLIN, 0}, {m_stopEvt, POLLIN, 0}};
+        Sample last;
+        bool   haveSample = false;
+        bool   ledKnown   = false;
+        bool   ledOn      = false;
+
+        for (;;)
+        {
+            if (::poll(fds, 2, -1) < 0)
+                continue;
+            if (fds[1].revents)
+                break;
+            uint64_t v;
+            (void)!::read(m_logicEvt, &v, sizeof(v));
+
+            bool kicked = m_kick.exchange(false, std::memory_order_acquire);
+            Sample s;
+            bool fresh = false;
+            while (m_toLogic.pop(s))
+            {
+                last       = s;
+                haveSample = true;
+                fresh      = true;
+                evaluate(last, ledKnown, ledOn);
+                if (m_toNet.push(last))
+                    signal(m_netEvt);
+            }
+            if (kicked && !fresh && haveSample)
+            {
+                evaluate(last, ledKnown, ledOn);
+                if (m_toNet.push(last))
+                    signal(m_netEvt);
+            }
+        }
+    }
+
+    // Threshold with hysteresis: on at the threshold, off only once the
+    // reading drops `hysteresis` below it. The GPIO is written on changes only.
+    void evaluate(Sample &s, bool &ledKnown, bool &ledOn)
+    {
+        const Milli threshold = m_threshold.load(std::memory_order_relaxed);
+        bool on = ledOn;
+        if (s.value >= threshold)
+            on = true;
+        else if (s.value < threshold - m_hysteresis.load(std::memory_order_relaxed))
+            on = false;
+
+        if (!ledKnown || on != ledOn)
+        {
+            ledOn    = on;
+            ledKnown = true;
+            m_led(on);
+        }
+        s.ledOn = ledOn;
+    }
+
+    SensorFn m_sensor;
+    LedFn    m_led;
+
+    std::atomic<Milli>  m_threshold;
+    std::atomic<Milli>  m_hysteresis;
+    std::atomic<bool>   m_kick{false};
+    std::atomic<long>   m_sampleMs{1000};
+
+    SpscQueue<Sample, kQueueDepth> m_toLogic;
+    SpscQueue<Sample, kQueueDepth> m_toNet;
+
+    int m_logicEvt  = -1;
+    int m_netEvt    = -1;
+    int m_stopEvt   = -1;
+    int m_periodEvt = -1;   // setSamplePeriod() -> sensor stage
+
+    std::thread m_sensorThread;
+    std::thread m_logicThread;
+};
+
+#endif
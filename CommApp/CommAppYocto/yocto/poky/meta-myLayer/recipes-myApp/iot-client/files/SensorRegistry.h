@@ -0,0 +1,213 @@
+#ifndef SENSORREGISTRY_H
+#define SENSORREGISTRY_H
+
+#include "iotproto/Milli.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** Upper bound on channels in one frame; keeps a Sample a fixed-size POD so
+ *  it can travel through the lock-free queues without allocating.       */
+static constexpr std::size_t kMaxChannels = 16;
+
+/** Every readable sensor on the board, opened once and sampled together.
+ *
+ *  Channels are discovered at startup from
+ *    /sys/class/thermal/thermal_zone<N>/temp       -> "tz<N>"          (C)
+ *    /sys/class/hwmon/hwmon<N>/temp<M>_input       -> "<chip>.temp<M>" (C)
+ *  and, when asked for,
+ *    /sys/devices/system/cpu/cpu<N>/cpufreq/scaling_cur_freq -> "cpu<N>.mhz"
+ *    /proc/loadavg                                 -> "load1"
+ *
+ *  Values are Milli. The sysfs files already count thousandths (m°C, and
+ *  kHz for the MHz channels) and are taken as they are; /proc/loadavg is
+ *  decimal text.
+ *
+ *  Each file stays open; a sample is one pread() at offset 0 per channel,
+ *  which sysfs and procfs regenerate on every read. Channel 0 is the
+ *  primary temperature the LED logic and the deadband act on: thermal
+ *  zone 0 when it exists, otherwise the first hwmon input, otherwise a
+ *  fixed 25 C placeholder.                                               */
+class SensorRegistry
+{
+public:
+    SensorRegistry() = default;
+    ~SensorRegistry() { closeAll(); }
+
+    SensorRegistry(const SensorRegistry &)            = delete;
+    SensorRegistry &operator=(const SensorRegistry &) = delete;
+
+    /** Enumerates the sensors. Returns the number of channels found.    */
+    std::size_t discover(bool withCpu)
+    {
+        closeAll();
+
+        for (const std::string &zone : listDir("/sys/class/thermal", "thermal_zone"))
+            addChannel("tz" + zone.substr(12),
+                       "/sys/class/thermal/" + zone + "/temp", true);
+
+        for (const std::string &hw : listDir("/sys/class/hwmon", "hwmon"))
+        {
+            const std::string dir  = "/sys/class/hwmon/" + hw;
+            std::string       chip = readWord(dir + "/name");
+            if (chip.empty())
+                chip = hw;
+            for (const std::string &f : listDir(dir, "temp"))
+            {
+                const std::size_t suffix = f.rfind("_input");
+                if (suffix == std::string::npos || suffix + 6 != f.size())
+                    continue;
+                addChannel(chip + "." + f.substr(0, suffix), dir + "/" + f, true);
+            }
+        }
+
+        // Keep a temperature in slot 0 even on a board without sensors, so
+        // the LED logic never ends up acting on a CPU frequency.
+        if (m_channels.empty())
+        {
+            std::cerr << "[SensorRegistry] no temperature sensors, reporting a fixed 25 C\n";
+            m_channels.push_back({"temp", -1, false, Milli::fromUnits(25)});
+        }
+
+        if (withCpu)
+        {
+            for (const std::string &cpu : listDir("/sys/devices/system/cpu", "cpu"))
+            {
+                if (cpu.size() < 4 || cpu.find_first_not_of("0123456789", 3) != std::string::npos)
+                    continue;
+                addChannel(cpu + ".mhz",
+                           "/sys/devices/system/cpu/" + cpu + "/cpufreq/scaling_cur_freq", true);
+            }
+            addChannel("load1", "/proc/loadavg", false);
+        }
+
+        return m_channels.size();
+    }
+
+    std::size_t size() const { return m_channels.size(); }
+
+    /** Channel names, comma separated, in frame order.                  */
+    std::string names() const
+    {
+        std::string out;
+        for (const Entry &e : m_channels)
+        {
+            if (!out.empty())
+                out += ',';
+            out += e.name;
+        }
+        return out;
+    }
+
+    /** One pass over every channel. Writes up to `max` values and returns
+     *  how many were written; a channel that fails to read repeats its
+     *  previous value so the frame layout never shifts.                 */
+    std::size_t sampleAll(Milli *out, std::size_t max)
+    {
+        if (m_channels.empty())
+        {
+            if (max > 0)
+                out[0] = Milli::fromUnits(25);
+            return max > 0 ? 1 : 0;
+        }
+
+        const std::size_t n = std::min(max, m_channels.size());
+        char buf[64];
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            Entry &e = m_channels[i];
+            ssize_t len = e.fd >= 0 ? ::pread(e.fd, buf, sizeof(buf), 0) : 0;
+            if (len > 0)
+            {
+                // First field only: loadavg carries four more after it.
+                const char *end = std::find_if(buf, buf + len, [](char c)
+                {
+                    return c == ' ' || c == '\n';
+                });
+                if (e.thousandths)
+                {
+                    int32_t raw = 0;
+                    auto [ptr, ec] = std::from_chars(buf, end, raw);
+                    if (ec == std::errc() && ptr == end)
+                        e.last = Milli::fromRaw(raw);
+                }
+                else
+                {
+                    Milli v;
+                    if (Milli::parse(std::string_view(buf, static_cast<std::size_t>(end - buf)), v))
+                        e.last = v;
+                }
+            }
+            out[i] = e.last;
+        }
+        return n;
+    }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        int         fd          = -1;
+        bool        thousandths = false;   // integer count of thousandths
+        Milli       last;
+    };
+
+    std::vector<Entry> m_channels;
+
+    void addChannel(const std::string &name, const std::string &path, bool thousandths)
+    {
+        if (m_channels.size() >= kMaxChannels)
+            return;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        m_channels.push_back({name, fd, thousandths, Milli()});
+    }
+
+    void closeAll()
+    {
+        for (Entry &e : m_channels)
+            if (e.fd >= 0)
+                ::close(e.fd);
+        m_channels.clear();
+    }
+
+    // Entries of `dir` starting with `prefix`, sorted so "tz0" stays first
+    // and channel order is stable across reboots.
+    static std::vector<std::string> listDir(const std::string &dir, const std::string &prefix)
+    {
+        std::vector<std::string> out;
+        DIR *d = ::opendir(dir.c_str());
+        if (!d)
+            return out;
+        while (struct dirent *ent = ::readdir(d))
+        {
+            std::string name = ent->d_name;
+            if (name.compare(0, prefix.size(), prefix) == 0)
+                out.push_back(name);
+        }
+        ::closedir(d);
+        std::sort(out.begin(), out.end(), [](const std::string &a, const std::string &b)
+        {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        });
+        return out;
+    }
+
+    static std::string readWord(const std::string &path)
+    {
+        std::ifstream f(path);
+        std::string word;
+        f >> word;
+        return word;
+    }
+};
+
+#endif
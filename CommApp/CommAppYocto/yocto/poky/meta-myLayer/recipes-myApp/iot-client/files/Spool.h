@@ -0,0 +1,377 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include "iotproto/Milli.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/** One spooled reading. The checksum covers everything before it so a
+ *  record torn by a power cut is detected and dropped on recovery.      */
+struct SpoolRecord
+{
+    int64_t  timestampMs = 0;
+    Milli    value;
+    uint32_t reserved    = 0;          // v2 and older: high half of a double
+    uint32_t seq         = 0;
+    uint32_t checksum    = 0;
+};
+static_assert(sizeof(SpoolRecord) == 24 && offsetof(SpoolRecord, seq) == 16,
+              "spool record layout is shared with older versions");
+
+/** Fixed-size circular store-and-forward buffer backed by a memory-mapped
+ *  file. Readings are appended while the server is unreachable and
+ *  replayed (peek + consume) once the connection is back.
+ *
+ *  Layout: one page-aligned header followed by `capacity` records.
+ *  head/tail are monotonically increasing record counters; the slot for
+ *  counter n is n % capacity. When the ring is full the oldest reading is
+ *  overwritten, so the file never grows past its initial size.
+ *
+ *  Timestamps are CLOCK_MONOTONIC, which restarts at every boot. The
+ *  header keeps the boot they belong to and that boot's wall-minus-
+ *  monotonic offset; records that survive a reboot are moved onto the
+ *  new boot's clock through the wall clock when the spool is opened
+ *  (version 1 spools held wall-clock stamps and convert the same way).
+ *  Versions before 3 stored the value as a double; those records are
+ *  converted to Milli on open. Either conversion is written to a copy
+ *  that is renamed over the file, so a power cut mid-way leaves the old
+ *  spool intact rather than half converted.                            */
+class Spool
+{
+public:
+    static constexpr uint32_t    kMagic           = 0x49534F31; // "ISO1"
+    static constexpr uint32_t    kVersion         = 3;
+    static constexpr std::size_t kDefaultCapacity = 32768;      // ~768 KiB
+
+    Spool() = default;
+    ~Spool() { close(); }
+
+    Spool(const Spool &)            = delete;
+    Spool &operator=(const Spool &) = delete;
+
+    /** Map (creating if necessary) the spool file. Returns false and leaves
+     *  the spool disabled if the file cannot be opened or mapped.        */
+    bool open(const std::string &path, std::size_t capacity = kDefaultCapacity)
+    {
+        close();
+        if (capacity == 0)
+            return false;
+
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0)
+        {
+            std::cerr << "[Spool] open(" << path << ") failed: "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        m_size = sizeof(Header) + capacity * sizeof(SpoolRecord);
+
+        // Reserve the blocks up front so a full SD card surfaces here as an
+        // error instead of as SIGBUS on a later store into the mapping.
+        int rc = ::posix_fallocate(m_fd, 0, static_cast<off_t>(m_size));
+        if (rc != 0)
+        {
+            std::cerr << "[Spool] fallocate failed: " << std::strerror(rc) << "\n";
+            close();
+            return false;
+        }
+
+        void *p = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (p == MAP_FAILED)
+        {
+            std::cerr << "[Spool] mmap failed: " << std::strerror(errno) << "\n";
+            m_map = nullptr;
+            close();
+            return false;
+        }
+        m_map     = p;
+        m_header  = static_cast<Header *>(p);
+        m_records = reinterpret_cast<SpoolRecord *>(static_cast<char *>(p) + sizeof(Header));
+
+        if (m_header->magic != kMagic
+            || m_header->version < 1 || m_header->version > kVersion
+            || m_header->capacity != capacity
+            || m_header->recordSize != sizeof(SpoolRecord)
+            || m_header->head < m_header->tail
+            || m_header->head - m_header->tail > capacity)
+        {
+            // Fresh file, different geometry or corrupt header: start empty.
+            std::memset(m_header, 0, sizeof(Header));
+            m_header->magic      = kMagic;
+            m_header->version    = kVersion;
+            m_header->capacity   = static_cast<uint32_t>(capacity);
+            m_header->recordSize = sizeof(SpoolRecord);
+            stampBoot(*m_header);
+            ::msync(m_header, sizeof(Header), MS_SYNC);
+        }
+        else
+        {
+            recover();
+            if (needsUpgrade())
+                return upgrade(path, capacity);
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (m_map)
+        {
+            ::msync(m_map, m_size, MS_SYNC);
+            ::munmap(m_map, m_size);
+        }
+        m_map     = nullptr;
+        m_header  = nullptr;
+        m_records = nullptr;
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    bool isOpen() const { return m_map != nullptr; }
+
+    std::size_t pending() const
+    {
+        return m_header ? static_cast<std::size_t>(m_header->head - m_header->tail) : 0;
+    }
+
+    /** Append a reading, overwriting the oldest one when the ring is full.
+     *  The record is written before head is advanced, so a crash between
+     *  the two stores loses at most this reading.                        */
+    void append(int64_t timestampMs, Milli value)
+    {
+        if (!m_header)
+            return;
+
+        const uint64_t cap = m_header->capacity;
+        if (m_header->head - m_header->tail == cap)
+            ++m_header->tail;
+
+        SpoolRecord &r = m_records[m_header->head % cap];
+        r.timestampMs = timestampMs;
+        r.value       = value;
+        r.seq         = static_cast<uint32_t>(m_header->head);
+        r.checksum    = checksum(r);
+        ++m_header->head;
+        m_header->clockOffsetMs = clockOffsetMs();   // tracks NTP steps
+    }
+
+    /** Copy up to `max` of the oldest readings into `out` without removing
+     *  them; call consume() once they have been delivered.              */
+    std::size_t peek(std::vector<SpoolRecord> &out, std::size_t max) const
+    {
+        out.clear();
+        if (!m_header)
+            return 0;
+        const uint64_t cap = m_header->capacity;
+        const std::size_t n = std::min(max, pending());
+        out.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            out.push_back(m_records[(m_header->tail + i) % cap]);
+        return n;
+    }
+
+    void consume(std::size_t n)
+    {
+        if (!m_header)
+            return;
+        m_header->tail += std::min<uint64_t>(n, m_header->head - m_header->tail);
+        if (m_header->tail == m_header->head)
+            ::msync(m_header, sizeof(Header), MS_SYNC);
+    }
+
+    /** Wall clock minus CLOCK_MONOTONIC, in milliseconds: what turns a
+     *  record's timestamp into Unix time on this boot.                  */
+    static int64_t clockOffsetMs()
+    {
+        struct timespec wall, mono;
+        ::clock_gettime(CLOCK_REALTIME, &wall);
+        ::clock_gettime(CLOCK_MONOTONIC, &mono);
+        return (static_cast<int64_t>(wall.tv_sec) - mono.tv_sec) * 1000
+             + (wall.tv_nsec - mono.tv_nsec) / 1000000;
+    }
+
+    /** Force dirty pages to the card, e.g. before a planned shutdown.   */
+    void flush()
+    {
+        if (m_map)
+            ::msync(m_map, m_size, MS_SYNC);
+    }
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t recordSize;
+        uint64_t head;
+        uint64_t tail;
+        int64_t  clockOffsetMs;        // v2: wall − monotonic of `bootId`
+        char     bootId[40];           // v2: /proc/sys/kernel/random/boot_id
+        uint8_t  pad[4096 - 80];
+    };
+    static_assert(sizeof(Header) == 4096, "spool header must fill one page");
+
+    static uint32_t checksum(const SpoolRecord &r)
+    {
+        // FNV-1a over the payload fields.
+        const auto *p = reinterpret_cast<const unsigned char *>(&r);
+        uint32_t h = 2166136261u;
+        for (std::size_t i = 0; i < offsetof(SpoolRecord, checksum); ++i)
+        {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    /** Drop any trailing records whose checksum or sequence number does
+     *  not match, i.e. those whose pages never reached the card.        */
+    void recover()
+    {
+        const uint64_t cap = m_header->capacity;
+        for (uint64_t n = m_header->tail; n < m_header->head; ++n)
+        {
+            const SpoolRecord &r = m_records[n % cap];
+            if (r.seq != static_cast<uint32_t>(n) || r.checksum != checksum(r))
+            {
+                std::cerr << "[Spool] Dropping " << (m_header->head - n)
+                          << " torn record(s)\n";
+                m_header->head = n;
+                break;
+            }
+        }
+    }
+
+    static std::string currentBootId()
+    {
+        std::ifstream f("/proc/sys/kernel/random/boot_id");
+        std::string id;
+        std::getline(f, id);
+        return id.substr(0, sizeof(Header::bootId) - 1);
+    }
+
+    static void stampBoot(Header &h)
+    {
+        const std::string id = currentBootId();
+        std::memset(h.bootId, 0, sizeof(h.bootId));
+        std::memcpy(h.bootId, id.data(), id.size());
+        h.clockOffsetMs = clockOffsetMs();
+        h.version       = kVersion;
+    }
+
+    /** Older format, or written on another boot. Without a boot id a
+     *  reboot cannot be told apart, and the stamps are left alone.     */
+    static bool otherBoot(const Header &h)
+    {
+        const std::string id = currentBootId();
+        return h.version == 1 || (!id.empty() && id != h.bootId);
+    }
+
+    bool needsUpgrade() const
+    {
+        return m_header->version != kVersion || otherBoot(*m_header);
+    }
+
+    /** Brings the records up to date: timestamps move onto this boot's
+     *  monotonic clock (v1 stamps were wall-clock, i.e. offset 0) and
+     *  pre-v3 doubles become Milli. Neither step can be repeated safely,
+     *  so it runs on a copy of the file: written out, fsync'd and
+     *  renamed over the original, then mapped afresh. If that fails the
+     *  old file stays as it was and the spool is disabled.             */
+    bool upgrade(const std::string &path, std::size_t capacity)
+    {
+        std::vector<char> image(static_cast<const char *>(m_map),
+                                static_cast<const char *>(m_map) + m_size);
+        Header      &h       = *reinterpret_cast<Header *>(image.data());
+        SpoolRecord *records = reinterpret_cast<SpoolRecord *>(image.data() + sizeof(Header));
+
+        const uint32_t from  = h.version;
+        const int64_t  delta = otherBoot(h)
+            ? (from == 1 ? 0 : h.clockOffsetMs) - clockOffsetMs() : 0;
+        for (uint64_t n = h.tail; n < h.head; ++n)
+        {
+            SpoolRecord &r = records[n % h.capacity];
+            r.timestampMs += delta;
+            if (from < 3)
+            {
+                double v;
+                std::memcpy(&v, reinterpret_cast<const char *>(&r) + offsetof(SpoolRecord, value), sizeof(v));
+                r.value    = Milli::fromDouble(v);
+                r.reserved = 0;
+            }
+            r.checksum = checksum(r);
+        }
+        stampBoot(h);
+
+        close();
+        const std::string tmp = path + ".upgrade";
+        if (!writeFile(tmp, image) || ::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            std::cerr << "[Spool] upgrade of " << path << " failed: "
+                      << std::strerror(errno) << "\n";
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        syncParentDir(path);
+        return open(path, capacity);
+    }
+
+    static bool writeFile(const std::string &path, const std::vector<char> &data)
+    {
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        std::size_t done = 0;
+        while (done < data.size())
+        {
+            const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<std::size_t>(n);
+        }
+        const bool ok = done == data.size() && ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    // Makes the rename itself durable.
+    static void syncParentDir(const std::string &path)
+    {
+        const std::size_t slash = path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash ? slash : 1);
+        const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    int          m_fd      = -1;
+    void        *m_map     = nullptr;
+    std::size_t  m_size    = 0;
+    Header      *m_header  = nullptr;
+    SpoolRecord *m_records = nullptr;
+};
+
+#endif
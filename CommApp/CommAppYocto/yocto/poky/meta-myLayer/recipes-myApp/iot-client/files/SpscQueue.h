@@ -0,0 +1,69 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/** Bounded single-producer / single-consumer ring. push() and pop() are
+ *  wait-free; exactly one thread may push and exactly one may pop. A full
+ *  queue never blocks the producer: the item is dropped and counted, so a
+ *  stalled consumer can never hold up the stage in front of it.
+ *
+ *  Capacity must be a power of two.                                      */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    /** Producer side. Returns false (and counts a drop) when full.     */
+    bool push(const T &item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+        {
+            m_drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_slots[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side. Returns false when empty.                        */
+    bool pop(T &item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+        item = m_slots[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Approximate when read from a third thread; exact from either end.
+     *  The tail is read first: both indices only grow, so head - tail
+     *  cannot go negative, and a push racing the two loads is clamped.  */
+    std::size_t depth() const
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        return head - tail < Capacity ? head - tail : Capacity;
+    }
+
+    uint64_t drops() const { return m_drops.load(std::memory_order_relaxed); }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    // Producer and consumer indices on separate cache lines so the two
+    // threads do not bounce the same line on every operation.
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    alignas(64) std::atomic<uint64_t>    m_drops{0};
+    T m_slots[Capacity];
+};
+
+#endif
@@ -1,8 +1,8 @@
 
 
 
-#include "Channel.h"
-#include "Socket.h"
+#include "iotproto/Channel.h"
+#include "iotproto/Socket.h"
 
 #include <iostream>
 #include <fstream>
@@ -1,385 +1,839 @@
-#include "Channel.h"
-
+#include "Config.h"
+#include "EventLoop.h"
+#include "Pipeline.h"
+#include "Spool.h"
+
+#include "iotproto/BatchCodec.h"
+#include "iotproto/Channel.h"
+#include "iotproto/ClientSocket.h"
+#include "iotproto/ShmSocket.h"
+#include "iotproto/LineFramer.h"
+#include "iotproto/Protocol.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <fstream>
 #include <csignal>
-#include <atomic>
 #include <chrono>
 #include <thread>
+#include <type_traits>
+#include <vector>
 #include <clocale>   // FIX (Bug E.4): force C locale for decimal-point consistency
 
-static std::atomic<bool> g_running{true};
-
-static void handleSignal(int) { g_running = false; }
+// Silence from the TCP server for this long means the link is dead. Replaces
+// the old SO_RCVTIMEO (Bug E.3), which could only fire while blocked in recv().
+static constexpr long kRxTimeoutMs = 10000;
+static constexpr long kReconnectMs = 3000;
+static constexpr long kKeepaliveMs = 5000;
 
-class TCPClientSocket : public TCPSocket
+static void setLed(int gpio, bool on)
 {
-private:
-    std::string m_ip;
-    uint16_t    m_port;
-    int         m_fd = -1;
-
-public:
-    TCPClientSocket(const std::string &ip, uint16_t port)
-        : m_ip(ip), m_port(port) {}
+    std::string g = std::to_string(gpio);
+    { std::ofstream f("/sys/class/gpio/export"); if (f.is_open()) f << g; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    { std::ofstream f("/sys/class/gpio/gpio" + g + "/direction"); if (f.is_open()) f << "out"; }
+    { std::ofstream f("/sys/class/gpio/gpio" + g + "/value");     if (f.is_open()) f << (on ? "1" : "0"); }
+}
 
-    int connect() override
-    {
-        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
-        if (m_fd < 0)
-            return -1;
-
-        struct sockaddr_in addr{};
-        std::memset(&addr, 0, sizeof(addr));
-        addr.sin_family = AF_INET;
-        addr.sin_port   = htons(m_port);
-        if (::inet_pton(AF_INET, m_ip.c_str(), &addr.sin_addr) != 1)
-        {
-            ::close(m_fd);
-            m_fd = -1;
-            return -1;
-        }
-        if (::connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
-        {
-            ::close(m_fd);
-            m_fd = -1;
-            return -1;
-        }
+static DisplayConfig g_display;
 
-        // FIX (Bug E.3): set a receive timeout so readLine() does not block
-        // indefinitely if the server stops responding (e.g. crash, network
-        // drop). After the timeout, recv() returns -1/EAGAIN and the
-        // reconnect loop is triggered.
-        struct timeval tv{};
-        tv.tv_sec  = 10;
-        tv.tv_usec = 0;
-        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-        // FIX (Bug 7): Socket::connect() contract is 0 on success / -1 on
-        // failure. The original returned m_fd (e.g. 4), which works with the
-        // >= 0 check but violates the interface and breaks any == 0 check.
-        return 0;
-    }
+// Not a terminal (systemd journal, pipe, file): never emit ANSI redraws.
+static void setDisplay(const DisplayConfig &display)
+{
+    g_display = display;
+    if (!::isatty(STDOUT_FILENO))
+        g_display.headless = true;
+}
 
-    void send(const std::string &message) override
+static void printDisplay(Milli temp, Milli threshold, bool ledOn,
+                         const SamplePipeline *pipe = nullptr)
+{
+    if (g_display.headless)
     {
-        if (m_fd < 0)
+        if (g_display.statusIntervalMs <= 0)
             return;
-        // FIX: MSG_NOSIGNAL prevents SIGPIPE from killing the process when
-        // the server has already closed the connection.
-        ::send(m_fd, message.c_str(), message.size(), MSG_NOSIGNAL);
+        std::cout << "status temp=" << temp << " threshold=" << threshold
+                  << " led=" << (ledOn ? "on" : "off");
+        if (pipe)
+            std::cout << " queue=" << pipe->sensorQueueDepth() << '/' << pipe->netQueueDepth()
+                      << " drops=" << pipe->sensorQueueDrops() << '/' << pipe->netQueueDrops();
+        std::cout << "\n";
+        std::cout.flush();
+        return;
     }
 
-    void shutdown() override
+    std::cout << "\033[2J\033[H";
+    std::cout << "IoT Client\n";
+    std::cout << "==========\n";
+    std::cout << "Temperature : " << temp      << " C\n";
+    std::cout << "Threshold   : " << threshold << " C\n";
+    std::cout << "LED Status  : " << (ledOn ? "ON" : "OFF") << "\n";
+    if (pipe)
+        std::cout << "Queues      : sensor " << pipe->sensorQueueDepth()
+                  << " (" << pipe->sensorQueueDrops() << " dropped), net "
+                  << pipe->netQueueDepth() << " (" << pipe->netQueueDrops() << " dropped)\n";
+    std::cout.flush();
+}
+
+/** State owned by the network stage of the TCP and UDP loops. `temperature`
+ *  and `ledOn` mirror the newest sample that came out of the pipeline; the
+ *  sensor and the GPIO themselves are only touched by the pipeline threads. */
+struct ClientState
+{
+    int             gpio        = 17;
+    Milli           temperature = Milli::fromUnits(25);
+    Milli           threshold   = Milli::fromUnits(50);
+    bool            ledOn       = false;
+    ReportPolicy    policy;         // config->policy, as the loop applies it
+    ClientConfig   *config      = nullptr;
+    SamplePipeline *pipeline    = nullptr;
+    std::string     channelNames;   // "tz0,tz1,..." when there is more than one
+    Sample          latest;         // every channel of the newest sample
+
+    // What the terminal currently shows, so we only redraw on a change.
+    bool   displayKnown = false;
+    Milli  shownTemp;
+    Milli  shownThresh;
+    bool   shownLed     = false;
+    std::chrono::steady_clock::time_point shownAt{};
+
+    bool   reported     = false;
+    Milli  lastReported;
+    std::chrono::steady_clock::time_point lastReportAt{};
+
+    // Stream session ("session <token> <n>"), resumed on every reconnect.
+    // `replayed` counts batch items consumed from the spool under it;
+    // `replaySeq` is the spool seq of the batch last sent.
+    Spool      *spool           = nullptr;
+    std::string sessionToken;
+    std::string peerCodecs;                // zbatch codecs the server decodes
+    uint64_t    replayed        = 0;
+    uint32_t    replaySeq       = 0;
+    bool        awaitingSession = false;   // replay held until the answer
+
+    // Set once "sync" is answered on this connection: from then on every
+    // reading and batch is stamped with the monotonic sample clock, which
+    // the server maps onto its own. Before that (or against a server that
+    // never asks) readings go unstamped and batches carry wall-clock time.
+    bool        synced          = false;
+};
+
+static void refreshDisplay(ClientState &st)
+{
+    if (st.displayKnown && st.shownTemp == st.temperature
+        && st.shownThresh == st.threshold && st.shownLed == st.ledOn)
+        return;
+
+    // Headless: leave the change pending until the interval has passed;
+    // the next sample tick picks it up, so the last state still gets logged.
+    const auto now = std::chrono::steady_clock::now();
+    if (g_display.headless && st.displayKnown
+        && now - st.shownAt < std::chrono::milliseconds(g_display.statusIntervalMs))
+        return;
+
+    printDisplay(st.temperature, st.threshold, st.ledOn, st.pipeline);
+    st.shownAt      = now;
+    st.displayKnown = true;
+    st.shownTemp    = st.temperature;
+    st.shownThresh  = st.threshold;
+    st.shownLed     = st.ledOn;
+}
+
+static bool reportDue(const ClientState &st)
+{
+    if (!st.policy.pushMode() || !st.reported)
+        return true;
+    if (std::abs((st.temperature - st.lastReported).raw) > st.policy.deadband.raw)
+        return true;
+    return st.policy.heartbeatMs > 0
+        && std::chrono::steady_clock::now() - st.lastReportAt
+               >= std::chrono::milliseconds(st.policy.heartbeatMs);
+}
+
+// A single-sensor board keeps sending the bare value; with more channels
+// the whole sample goes out as "frame <v0>,<v1>,..." in announced order.
+// `tag` ("#<id> ") marks it as the answer to a tagged "get temp".
+static void reportReading(ClientState &st, Channel &channel, std::string_view tag = {})
+{
+    std::ostringstream oss;
+    oss << tag;
+    if (st.latest.channelCount > 1)
     {
-        if (m_fd >= 0)
-        {
-            ::close(m_fd);
-            m_fd = -1;
-        }
+        oss << proto::Frame::keyword << ' ';
+        for (std::size_t i = 0; i < st.latest.channelCount; ++i)
+            oss << (i ? "," : "") << st.latest.channels[i];
     }
+    else
+    {
+        oss << st.temperature;
+    }
+    if (st.synced)
+        oss << " @" << st.latest.timestampMs;
+    channel.send(oss.str() + "\n");
+    st.reported     = true;
+    st.lastReported = st.temperature;
+    st.lastReportAt = std::chrono::steady_clock::now();
+}
 
-    int fd() const override { return m_fd; }
-};
+// Called for every sample the pipeline hands to the network stage. In push
+// mode this is what drives the uplink; in poll mode it only records the
+// newest reading for the next "get temp".
+static void onSample(ClientState &st, const Sample &s, Channel *channel)
+{
+    st.temperature = s.value;
+    st.ledOn       = s.ledOn;
+    st.latest      = s;
+    if (channel && st.policy.pushMode() && reportDue(st))
+        reportReading(st, *channel);
+    if (st.policy.pushMode() || g_display.headless)
+        refreshDisplay(st);
+}
+
+// Re-tunes the running loop to `next`: sample period, report policy,
+// replay batch size and display. Returns false, changing nothing, if
+// `next` also differs in a setting the loop was built from (transport,
+// GPIO, spool, sensors); only a new loop can pick that up. A change of
+// report mode is announced on `channel`, or by announceMode() on the
+// next connect if the link is down (null).
+static bool applyConfig(ClientState &st, const ClientConfig &next, Channel *channel)
+{
+    ClientConfig &cfg = *st.config;
+    if (config::needsRestart(cfg, next))
+        return false;
+    if (st.pipeline && next.sampleMs != cfg.sampleMs)
+        st.pipeline->setSamplePeriod(next.sampleMs);
+    if (st.pipeline && next.policy.hysteresis != cfg.policy.hysteresis)
+        st.pipeline->setHysteresis(next.policy.hysteresis);
+
+    const bool wasPushing = st.policy.pushMode();
+    cfg       = next;
+    st.policy = cfg.policy;
+    setDisplay(cfg.display);
+    st.displayKnown = false;
+    if (channel && st.policy.pushMode() != wasPushing)
+        channel->send(std::string(proto::Mode::keyword)
+                      + (st.policy.pushMode() ? " push\n" : " poll\n"));
+    return true;
+}
 
-class UDPClientSocket : public UDPSocket
+// Handler for the commands the server sends; Protocol.h matches the line
+// and parses the arguments, then calls the overload for that command.
+struct CommandHandler
 {
-private:
-    std::string        m_ip;
-    uint16_t           m_port;
-    int                m_fd = -1;
-    struct sockaddr_in m_serverAddr{};
-
-public:
-    UDPClientSocket(const std::string &ip, uint16_t port)
-        : m_ip(ip), m_port(port)
+    ClientState &st;
+    Channel     &channel;
+    std::string  tag;               // "#<id> " of a tagged command, else empty
+    bool         answered = false;  // the reply carried the tag already
+    bool         refused  = false;  // parsed, but the client said no
+
+    // FIX (Bug 5): "set threshold" and its value are now combined into a
+    // single message: "set threshold <value>".  The old two-message
+    // approach (separate command + value sends) caused the value to be
+    // consumed by the wrong readLine() call when TCP coalesced packets,
+    // and was unreliable over UDP (packets can be reordered or dropped).
+    void operator()(const proto::SetThreshold &cmd)
     {
-        std::memset(&m_serverAddr, 0, sizeof(m_serverAddr));
+        st.threshold = cmd.value;
+        // The logic stage re-evaluates the LED and hands back a sample with
+        // the new state; the display catches up when that arrives.
+        if (st.pipeline)
+            st.pipeline->setThreshold(st.threshold);
+        refreshDisplay(st);
     }
 
-    int connect() override
+    void operator()(const proto::GetTemp &)
     {
-        m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
-        if (m_fd < 0)
-            return -1;
-
-        std::memset(&m_serverAddr, 0, sizeof(m_serverAddr));
-        m_serverAddr.sin_family = AF_INET;
-        m_serverAddr.sin_port   = htons(m_port);
-        if (::inet_pton(AF_INET, m_ip.c_str(), &m_serverAddr.sin_addr) != 1)
+        // Answer from the newest pipeline sample (at most one sample period
+        // old) instead of reading sysfs on the network thread.
+        if (reportDue(st))
         {
-            ::close(m_fd);
-            m_fd = -1;
-            return -1;
+            reportReading(st, channel, tag);
+            answered = true;
         }
-
-        struct timeval tv{};
-        tv.tv_sec  = 5;
-        tv.tv_usec = 0;
-        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-        // FIX (Bug 7): return 0 on success to match Socket::connect() contract.
-        return 0;
+        refreshDisplay(st);
     }
 
-    void send(const std::string &message) override
+    // Answered at once, so the server's round trip is the network's.
+    void operator()(const proto::Sync &s)
     {
-        if (m_fd < 0)
-            return;
-        ::sendto(m_fd, message.c_str(), message.size(), 0,
-                 reinterpret_cast<const sockaddr *>(&m_serverAddr),
-                 sizeof(m_serverAddr));
+        channel.send(std::string(proto::Synced::keyword) + " " + std::to_string(s.serverMs)
+                     + " " + std::to_string(SamplePipeline::nowMs()) + "\n");
+        st.synced = true;
     }
 
-    std::string receiveFrom()
+    // All or nothing: one bad or non-live key and the running settings
+    // stay as they are. They hold until the file is reloaded.
+    void operator()(const proto::SetConfig &cmd)
     {
-        char buf[256] = {};
-        struct sockaddr_in from{};
-        socklen_t fromLen = sizeof(from);
-        int n = ::recvfrom(m_fd, buf, sizeof(buf) - 1, 0,
-                           reinterpret_cast<sockaddr *>(&from), &fromLen);
-        if (n <= 0)
-            return {};
-        buf[n] = '\0';
-        return std::string(buf);
+        ClientConfig next = *st.config;
+        cmd.forEach([&](std::string_view key, std::string_view value)
+        {
+            const config::Status status = config::set(next, key, value, true);
+            if (status != config::Status::Ok)
+            {
+                std::cerr << "[Config] set config " << key << "=" << value << ": "
+                          << config::describe(status) << "\n";
+                refused = true;
+            }
+        });
+        if (!refused)
+            applyConfig(st, next, &channel);
     }
 
-    void shutdown() override
+    void operator()(const proto::Session &s)
     {
-        if (m_fd >= 0)
+        st.peerCodecs.assign(s.codecs.data(), s.codecs.size());
+        if (s.token != st.sessionToken)
         {
-            ::close(m_fd);
-            m_fd = -1;
+            st.sessionToken.assign(s.token.data(), s.token.size());
+            st.replayed = s.records;
+            return;
         }
-    }
 
-    int fd() const override { return m_fd; }
+        // Resumed. Items the server holds beyond what we consumed were in
+        // the batch that was in flight when the link dropped; skip them
+        // rather than send them twice, unless the spool has overwritten
+        // that batch in the meantime.
+        if (s.records > st.replayed && st.spool)
+        {
+            std::vector<SpoolRecord> head;
+            const std::size_t extra = static_cast<std::size_t>(s.records - st.replayed);
+            if (st.spool->peek(head, 1) == 1 && head.front().seq == st.replaySeq)
+                st.spool->consume(extra);
+        }
+        st.replayed = s.records;
+    }
 };
 
-static double readTemperature()
+// A tagged command ("#<id> ...") is always answered under its tag: with
+// the reading for "get temp", otherwise "ok" or "err".
+static void handleCommand(std::string_view cmd, ClientState &st, Channel &channel)
 {
-    std::ifstream f("/sys/class/thermal/thermal_zone0/temp");
-    if (!f.is_open())
-        return 25.0;
-    int millideg = 0;
-    f >> millideg;
-    return static_cast<double>(millideg) / 1000.0;
+    uint32_t id = 0;
+    const bool tagged = proto::splitTag(cmd, id);
+
+    CommandHandler handler { st, channel, tagged ? proto::tag(id, "") : std::string() };
+    const proto::Result result = proto::dispatch(cmd, handler);
+    switch (result)
+    {
+    case proto::Result::Handled:
+        break;
+    case proto::Result::BadArgs:
+        std::cerr << "Bad arguments: " << cmd << "\n";
+        break;
+    default:
+        std::cerr << "Unknown command: " << cmd << "\n";
+        break;
+    }
+    if (tagged && !handler.answered)
+        channel.send(proto::tag(id, result == proto::Result::Handled && !handler.refused
+                                        ? proto::kReplyOk : proto::kReplyErr) + "\n");
 }
 
-static void setLed(int gpio, bool on)
+// First line on every stream connect. The answer ("session") settles the
+// session before anything from the spool is replayed.
+static void requestSession(ClientState &st, Channel &channel)
 {
-    std::string g = std::to_string(gpio);
-    { std::ofstream f("/sys/class/gpio/export"); if (f.is_open()) f << g; }
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    { std::ofstream f("/sys/class/gpio/gpio" + g + "/direction"); if (f.is_open()) f << "out"; }
-    { std::ofstream f("/sys/class/gpio/gpio" + g + "/value");     if (f.is_open()) f << (on ? "1" : "0"); }
+    std::string line(proto::Resume::keyword);
+    if (!st.sessionToken.empty())
+        line += " " + st.sessionToken;
+    channel.send(line + "\n");
+    st.awaitingSession = true;
+    st.peerCodecs.clear();                 // until this server lists its own
+    st.synced = false;                     // until this server asks
 }
 
-static void printDisplay(double temp, double threshold, bool ledOn)
+// Sent first on every connect: the channel layout of the frames that
+// follow, that tagged commands are understood (servers that predate tags
+// ignore the line) and, in push mode, that the server can stop sending
+// "get temp".
+static void announceMode(const ClientState &st, Channel &channel)
 {
-    std::cout << "\033[2J\033[H";
-    std::cout << "IoT Client\n";
-    std::cout << "==========\n";
-    std::cout << "Temperature : " << temp      << " C\n";
-    std::cout << "Threshold   : " << threshold << " C\n";
-    std::cout << "LED Status  : " << (ledOn ? "ON" : "OFF") << "\n";
-    std::cout.flush();
+    if (!st.channelNames.empty())
+        channel.send(std::string(proto::Channels::keyword) + " " + st.channelNames + "\n");
+    channel.send(std::string(proto::Mode::keyword) + " ids\n");
+    if (st.policy.pushMode())
+        channel.send(std::string(proto::Mode::keyword) + " push\n");
 }
 
-// FIX (Bug E.3): readLine() now returns "" on both clean disconnect and on
-// SO_RCVTIMEO expiry (EAGAIN/EWOULDBLOCK), letting the caller trigger a
-// reconnect instead of blocking forever.
-static std::string readLine(ClientChannel &ch)
+// Format the next spool batch as "batch <ms>:<temp>,<ms>:<temp>,...", or
+// as "zbatch ..." if the server listed a codec for it (BatchCodec.h).
+// `stampOffsetMs` is added to every timestamp (see ClientState::synced).
+// Returns the number of records in it (0 when the spool is empty).
+static std::size_t formatSpoolBatch(const Spool &spool, std::size_t maxRecords,
+                                    std::string_view codecs, int64_t stampOffsetMs,
+                                    std::string &line, uint32_t &firstSeq)
 {
-    std::string line;
-    char c = '\0';
-    while (g_running)
+    std::vector<SpoolRecord> batch;
+    if (spool.peek(batch, maxRecords) == 0)
+        return 0;
+    firstSeq = batch.front().seq;
+    for (SpoolRecord &r : batch)
+        r.timestampMs += stampOffsetMs;
+
+    if (batchcodec::listed(codecs, batchcodec::kDelta))
+    {
+        std::vector<batchcodec::Record> records;
+        records.reserve(batch.size());
+        for (const SpoolRecord &r : batch)
+            records.push_back({ r.timestampMs, r.value });
+        line = std::string(proto::ZBatch::keyword) + " "
+             + batchcodec::encode(records, batchcodec::listed(codecs, batchcodec::kDeltaLz4))
+             + "\n";
+        return batch.size();
+    }
+
+    std::ostringstream oss;
+    oss << proto::Batch::keyword << ' ';
+    for (std::size_t i = 0; i < batch.size(); ++i)
     {
-        int n = ::recv(ch.fd(), &c, 1, 0);
-        if (n < 0)
+        if (i)
+            oss << ',';
+        oss << batch[i].timestampMs << ':' << batch[i].value;
+    }
+    oss << '\n';
+    line = oss.str();
+    return batch.size();
+}
+
+// The sensor stage reads every registered channel in one pass.
+static SamplePipeline::SensorFn makeSensorFn(SensorRegistry &sensors)
+{
+    return [&sensors](Sample &s) { s.channelCount = sensors.sampleAll(s.channels, kMaxChannels); };
+}
+
+// First reading taken on the main thread so the initial screen and the
+// first UDP report have a value before the pipeline produces one.
+static void initState(ClientState &st, SensorRegistry &sensors)
+{
+    st.latest.timestampMs  = SamplePipeline::nowMs();
+    st.latest.channelCount = sensors.sampleAll(st.latest.channels, kMaxChannels);
+    st.latest.value        = st.latest.channels[0];
+    st.temperature         = st.latest.value;
+    if (sensors.size() > 1)
+        st.channelNames = sensors.names();
+}
+
+/** How a connection loop ended: a signal to quit, or a reloaded config
+ *  that the loop cannot apply in place (main builds a new one).       */
+enum class LoopExit { Quit, Rebuild };
+
+// SIGHUP or saving the config file re-reads it (defaults, file, flags)
+// and applies what can be applied in place; the rest rebuilds the loop.
+// Settings pushed by the server are replaced by the file's. A file that
+// does not parse changes nothing. SIGINT/SIGTERM quit. `uplink` is the
+// channel while the link is up, else null.
+static void watchConfig(EventLoop &loop, SignalFd &signals, FileWatch &watch,
+                        ClientState &st, const ConfigSource &source,
+                        std::function<Channel *()> uplink, LoopExit &exit)
+{
+    auto reload = [&loop, &st, &source, uplink, &exit]()
+    {
+        ClientConfig next;
+        if (!source.load(next))
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                // SO_RCVTIMEO expired — server may be unresponsive.
-                std::cerr << "Read timeout — server not responding.\n";
-            }
-            return "";  // trigger reconnect in caller
+            std::cerr << "[Config] Reload failed; keeping the running configuration.\n";
+            return;
         }
-        if (n == 0)
-            return "";  // clean EOF
-        if (c == '\n')
-            break;
-        if (c != '\r')
-            line += c;
-    }
-    return line;
+        if (applyConfig(st, next, uplink()))
+        {
+            std::cout << "Configuration reloaded.\n";
+            std::cout.flush();
+            return;
+        }
+        *st.config = next;
+        std::cout << "Configuration reloaded; restarting the connection.\n";
+        std::cout.flush();
+        exit = LoopExit::Rebuild;
+        loop.stop();
+    };
+
+    loop.add(signals.fd(), EPOLLIN, [&loop, &signals, reload](uint32_t)
+    {
+        if (signals.read() == SIGHUP)
+            reload();
+        else
+            loop.stop();
+    });
+    if (watch.fd() >= 0)
+        loop.add(watch.fd(), EPOLLIN, [&watch, reload](uint32_t)
+        {
+            if (watch.changed())
+                reload();
+        });
 }
 
-static void runTCP(const std::string &ip, int gpio)
+/** Connection-oriented loop shared by TCP, Unix stream and shared memory:
+ *  `Sock` provides connect/finishConnect/read/flush/pendingBytes on top of
+ *  the Socket interface. `peer` is only used for messages.             */
+template <typename Sock>
+static LoopExit runStream(Sock &sock, const char *name, const std::string &peer,
+                          SensorRegistry &sensors, Spool &spool,
+                          ClientConfig &cfg, const ConfigSource &source)
 {
-    TCPClientSocket sock(ip, 8080);
+    SignalFd  signals{SIGINT, SIGTERM, SIGHUP};
+    FileWatch configWatch(source.path());
+    EventLoop loop;
+    TimerFd   reconnectTimer;
+    TimerFd   rxWatchdog;
+    LoopExit  exit = LoopExit::Quit;
+
     ClientChannel   channel;
     channel.channelSocket = &sock;
 
-    double temperature = readTemperature();
-    double threshold   = 50.0;
-    bool   ledOn       = false;
-
-    printDisplay(temperature, threshold, ledOn);
-    std::cout << "Connecting TCP to " << ip << ":8080 ...\n";
+    const int gpio = cfg.gpio;
+    ClientState st;
+    st.gpio        = gpio;
+    st.policy      = cfg.policy;
+    st.config      = &cfg;
+    st.spool       = &spool;
+    initState(st, sensors);
+
+    // Created after SignalFd so the stage threads inherit the blocked
+    // SIGINT/SIGTERM/SIGHUP mask and signals are only ever seen by the
+    // event loop.
+    SamplePipeline pipeline(makeSensorFn(sensors), [gpio](bool on) { setLed(gpio, on); },
+                            st.threshold, cfg.policy.hysteresis);
+    st.pipeline = &pipeline;
+
+    enum class Link { Down, Connecting, Up };
+    Link        link = Link::Down;
+    LineFramer  rxFramer;
+    // Records in the batch currently sitting in the socket's send queue.
+    // They are consumed from the spool only once that queue has drained,
+    // so a drop mid-replay leaves them in place for the next connection.
+    std::size_t replayInFlight = 0;
+
+    printDisplay(st.temperature, st.threshold, st.ledOn, st.pipeline);
+    std::cout << "Connecting " << name << " to " << peer << " ...\n";
     std::cout.flush();
 
-    while (g_running)
-    {
-        // FIX (Bug 7): connect() now returns 0 on success.
-        if (channel.channelSocket->connect() == 0)
-            break;
-        std::cerr << "Retrying in 3s...\n";
-        std::this_thread::sleep_for(std::chrono::seconds(3));
-    }
+    std::function<void()> startConnect;
 
-    if (!g_running)
+    auto dropLink = [&](const char *why)
     {
+        if (sock.fd() >= 0)
+            loop.remove(sock.fd());
         channel.stop();
-        return;
-    }
-
-    printDisplay(temperature, threshold, ledOn);
-    std::cout << "Connected via TCP.\n";
-    std::cout.flush();
+        rxFramer.clear();
+        replayInFlight = 0;
+        rxWatchdog.disarm();
+        std::cout << why << " Reconnecting in 3s...\n";
+        std::cout.flush();
+        link = Link::Down;
+        reconnectTimer.arm(kReconnectMs);
+    };
+
+    // Keep at most one replay batch queued behind the live traffic; the next
+    // one is formatted when the kernel has taken the previous one.
+    auto pumpReplay = [&]()
+    {
+        if (st.awaitingSession || sock.pendingBytes() > 0)
+            return;
+        if (replayInFlight > 0)
+        {
+            spool.consume(replayInFlight);
+            st.replayed   += replayInFlight;
+            replayInFlight = 0;
+        }
+        std::string line;
+        replayInFlight = formatSpoolBatch(spool, cfg.replayBatch, st.peerCodecs,
+                                          st.synced ? 0 : Spool::clockOffsetMs(),
+                                          line, st.replaySeq);
+        if (replayInFlight > 0)
+            channel.send(line);
+    };
+
+    auto updateInterest = [&]()
+    {
+        uint32_t ev = EPOLLIN | EPOLLRDHUP;
+        if (sock.pendingBytes() > 0)
+            ev |= EPOLLOUT;
+        loop.modify(sock.fd(), ev);
+    };
 
-    while (g_running)
+    auto onSocket = [&](uint32_t events)
     {
-        std::string cmd = readLine(channel);
-        if (cmd.empty())
+        if (link == Link::Connecting)
         {
-            std::cout << "Server disconnected. Reconnecting in 3s...\n";
-            channel.stop();
-            std::this_thread::sleep_for(std::chrono::seconds(3));
-            // Re-create socket and reconnect
-            TCPClientSocket newSock(ip, 8080);
-            sock = newSock;
-            channel.channelSocket = &sock;
-            while (g_running && channel.channelSocket->connect() != 0)
+            int err = sock.finishConnect();
+            if (err != 0)
+            {
+                std::cerr << "Connect failed: " << std::strerror(err) << "\n";
+                dropLink("Retrying.");
+                return;
+            }
+            link = Link::Up;
+            if constexpr (std::is_same_v<Sock, TCPClientSocket>)
             {
-                std::cerr << "Retrying in 3s...\n";
-                std::this_thread::sleep_for(std::chrono::seconds(3));
+                if (!sock.setTxMode(cfg.txMode))
+                    std::cerr << "[TCP] setsockopt(TCP_NODELAY) failed: " << std::strerror(errno) << "\n";
             }
-            std::cout << "Reconnected.\n";
-            continue;
+            rxWatchdog.arm(kRxTimeoutMs);
+            printDisplay(st.temperature, st.threshold, st.ledOn, st.pipeline);
+            std::cout << "Connected via " << name << ".\n";
+            if (spool.pending() > 0)
+                std::cout << "Replaying " << spool.pending() << " spooled reading(s)...\n";
+            std::cout.flush();
+            st.displayKnown = false;
+            st.reported     = false;   // push a fresh reading on every connect
+            {
+                // Session request and mode lines leave as one segment; the
+                // replay starts once the server has answered.
+                TcpCork cork(std::is_same_v<Sock, TCPClientSocket> ? sock.fd() : -1);
+                requestSession(st, channel);
+                announceMode(st, channel);
+            }
+            updateInterest();
+            return;
         }
 
-        // FIX (Bug 5): "set threshold" and its value are now combined into a
-        // single message: "set threshold <value>".  The old two-message
-        // approach (separate command + value sends) caused the value to be
-        // consumed by the wrong readLine() call when TCP coalesced packets.
-        if (cmd.rfind("set threshold ", 0) == 0)
+        if (events & EPOLLIN)
         {
-            try   { threshold = std::stod(cmd.substr(14)); }
-            catch (...) { std::cerr << "Bad threshold value: " << cmd << "\n"; }
-            ledOn = (temperature >= threshold);
-            setLed(gpio, ledOn);
-            printDisplay(temperature, threshold, ledOn);
+            char buf[512];
+            for (;;)
+            {
+                ssize_t n = sock.read(buf, sizeof(buf));
+                if (n > 0)
+                {
+                    rxFramer.feed(buf, static_cast<std::size_t>(n), [&](std::string_view cmd)
+                    {
+                        handleCommand(cmd, st, channel);
+                        // A server without sessions answers with something
+                        // else; its first line ends the wait just the same.
+                        st.awaitingSession = false;
+                    });
+                    continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    break;
+                if (n < 0 && errno == EINTR)
+                    continue;
+                dropLink("Server disconnected.");
+                return;
+            }
+            rxWatchdog.arm(kRxTimeoutMs);
         }
-        else if (cmd == "get temp")
+        else if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
         {
-            temperature = readTemperature();
-            std::ostringstream oss;
-            oss << temperature;
-            channel.send(oss.str() + "\n");
-            ledOn = (temperature >= threshold);
-            setLed(gpio, ledOn);
-            printDisplay(temperature, threshold, ledOn);
+            dropLink("Server disconnected.");
+            return;
         }
-        else
+
+        if (!sock.flush())
         {
-            std::cerr << "Unknown command: " << cmd << "\n";
+            dropLink("Send failed.");
+            return;
         }
-    }
+        pumpReplay();
+        updateInterest();
+    };
+
+    startConnect = [&]()
+    {
+        if (sock.connect() != 0)
+        {
+            std::cerr << "Retrying in 3s...\n";
+            reconnectTimer.arm(kReconnectMs);
+            return;
+        }
+        link = Link::Connecting;
+        // EPOLLIN too: a shared-memory connect is done already and only
+        // ever signals readable.
+        loop.add(sock.fd(), EPOLLIN | EPOLLOUT, onSocket);
+    };
+
+    watchConfig(loop, signals, configWatch, st, source,
+                [&]() -> Channel * { return link == Link::Up ? &channel : nullptr; }, exit);
+
+    // Sampling keeps running whatever the link state; while the server is
+    // unreachable every sample goes to the spool, stamped with the time it
+    // was taken rather than the time it reached this thread.
+    loop.add(pipeline.outputFd(), EPOLLIN, [&](uint32_t)
+    {
+        pipeline.ackOutput();
+        Sample s;
+        while (pipeline.pop(s))
+        {
+            onSample(st, s, link == Link::Up ? &channel : nullptr);
+            if (link != Link::Up && spool.isOpen())
+                spool.append(s.timestampMs, s.value);
+        }
+        if (link == Link::Up)
+            updateInterest();
+    });
+
+    loop.add(reconnectTimer.fd(), EPOLLIN, [&](uint32_t)
+    {
+        reconnectTimer.drain();
+        startConnect();
+    });
+
+    // FIX (Bug E.3): a silent server no longer blocks us forever; the
+    // watchdog fires after kRxTimeoutMs without data and forces a reconnect.
+    loop.add(rxWatchdog.fd(), EPOLLIN, [&](uint32_t)
+    {
+        rxWatchdog.drain();
+        if (link == Link::Up)
+        {
+            std::cerr << "Read timeout — server not responding.\n";
+            dropLink("Link timed out.");
+        }
+    });
+
+    pipeline.start(cfg.sampleMs);
+    startConnect();
+    loop.run();
 
+    pipeline.stop();
+    if (sock.fd() >= 0)
+        loop.remove(sock.fd());
     channel.stop();
+    spool.flush();
     setLed(gpio, false);
+    return exit;
 }
 
-static void runUDP(const std::string &ip, int gpio)
+/** Datagram loop shared by UDP and Unix datagrams; `Sock` needs a
+ *  non-blocking receiveFrom().                                         */
+template <typename Sock>
+static LoopExit runDatagram(Sock &sock, const char *name, const std::string &peer,
+                            SensorRegistry &sensors, ClientConfig &cfg,
+                            const ConfigSource &source)
 {
-    UDPClientSocket sock(ip, 8081);
+    SignalFd  signals{SIGINT, SIGTERM, SIGHUP};
+    FileWatch configWatch(source.path());
+    EventLoop loop;
+    TimerFd   keepaliveTimer;
+    LoopExit  exit = LoopExit::Quit;
+
     ClientChannel   channel;
     channel.channelSocket = &sock;
 
-    double temperature = readTemperature();
-    double threshold   = 50.0;
-    bool   ledOn       = false;
-
-    printDisplay(temperature, threshold, ledOn);
-    std::cout << "Connecting UDP to " << ip << ":8081 ...\n";
+    const int gpio = cfg.gpio;
+    ClientState st;
+    st.gpio        = gpio;
+    st.policy      = cfg.policy;
+    st.config      = &cfg;
+    initState(st, sensors);
+
+    // Created after SignalFd so the stage threads inherit the blocked
+    // SIGINT/SIGTERM/SIGHUP mask and signals are only ever seen by the
+    // event loop.
+    SamplePipeline pipeline(makeSensorFn(sensors), [gpio](bool on) { setLed(gpio, on); },
+                            st.threshold, cfg.policy.hysteresis);
+    st.pipeline = &pipeline;
+
+    printDisplay(st.temperature, st.threshold, st.ledOn, st.pipeline);
+    std::cout << "Connecting " << name << " to " << peer << " ...\n";
     std::cout.flush();
 
     if (channel.channelSocket->connect() != 0)  // FIX (Bug 7): check == 0
     {
-        std::cerr << "Failed to create UDP socket.\n";
-        return;
+        std::cerr << "Failed to create " << name << " socket.\n";
+        return LoopExit::Quit;
     }
 
-    printDisplay(temperature, threshold, ledOn);
+    printDisplay(st.temperature, st.threshold, st.ledOn, st.pipeline);
     std::cout << "Ready. Sending initial temperature...\n";
     std::cout.flush();
 
-    std::ostringstream initOss;
-    initOss << temperature;
-    channel.send(initOss.str() + "\n");
+    reportReading(st, channel);
+    announceMode(st, channel);
 
-    while (g_running)
-    {
-        UDPClientSocket *udp = static_cast<UDPClientSocket *>(channel.channelSocket);
-        std::string pkt = udp->receiveFrom();
+    auto lastRx = std::chrono::steady_clock::now();
 
-        if (pkt.empty())
-        {
-            // Timeout or error — send a keepalive temperature reading so the
-            // server stays aware we are still alive (server needs at least
-            // one datagram to capture the client's address for sendReply()).
-            temperature = readTemperature();
-            std::ostringstream oss;
-            oss << temperature;
-            channel.send(oss.str() + "\n");
-            continue;
-        }
+    watchConfig(loop, signals, configWatch, st, source,
+                [&]() -> Channel * { return &channel; }, exit);
 
-        while (!pkt.empty() && (pkt.back() == '\n' || pkt.back() == '\r'))
-            pkt.pop_back();
+    loop.add(pipeline.outputFd(), EPOLLIN, [&](uint32_t)
+    {
+        pipeline.ackOutput();
+        Sample s;
+        while (pipeline.pop(s))
+            onSample(st, s, &channel);
+    });
+
+    // Keepalive: if the server has been silent for a whole period, send a
+    // temperature reading so it stays aware we are still alive (the server
+    // needs at least one datagram to capture our address for sendReply()).
+    loop.add(keepaliveTimer.fd(), EPOLLIN, [&](uint32_t)
+    {
+        keepaliveTimer.drain();
+        if (std::chrono::steady_clock::now() - lastRx
+            >= std::chrono::milliseconds(kKeepaliveMs))
+            reportReading(st, channel);
+    });
 
-        // FIX (Bug 5): parse combined "set threshold <value>" message.
-        // Old code called receiveFrom() a second time to get the value, which
-        // is unreliable over UDP (packets can be reordered or dropped).
-        if (pkt.rfind("set threshold ", 0) == 0)
-        {
-            try   { threshold = std::stod(pkt.substr(14)); }
-            catch (...) { std::cerr << "Bad threshold value: " << pkt << "\n"; }
-            ledOn = (temperature >= threshold);
-            setLed(gpio, ledOn);
-            printDisplay(temperature, threshold, ledOn);
-        }
-        else if (pkt == "get temp")
-        {
-            temperature = readTemperature();
-            std::ostringstream oss;
-            oss << temperature;
-            channel.send(oss.str() + "\n");
-            ledOn = (temperature >= threshold);
-            setLed(gpio, ledOn);
-            printDisplay(temperature, threshold, ledOn);
-        }
-        else
+    loop.add(sock.fd(), EPOLLIN, [&](uint32_t)
+    {
+        for (std::string pkt = sock.receiveFrom(); !pkt.empty(); pkt = sock.receiveFrom())
         {
-            std::cerr << "Unknown packet: " << pkt << "\n";
+            lastRx = std::chrono::steady_clock::now();
+            while (!pkt.empty() && (pkt.back() == '\n' || pkt.back() == '\r'))
+                pkt.pop_back();
+            if (!pkt.empty())
+                handleCommand(pkt, st, channel);
         }
-    }
+    });
+
+    pipeline.start(cfg.sampleMs);
+    keepaliveTimer.arm(kKeepaliveMs, kKeepaliveMs);
+    loop.run();
 
+    pipeline.stop();
+    loop.remove(sock.fd());
     channel.stop();
     setLed(gpio, false);
+    return exit;
+}
+
+// One connection loop, built from `cfg`: sensors, spool and transport.
+static LoopExit runClient(ClientConfig &cfg, const ConfigSource &source)
+{
+    SensorRegistry sensors;
+    std::size_t found = sensors.discover(cfg.withCpu);
+    std::cerr << "Sensors: " << found << " channel(s)"
+              << (found ? " [" + sensors.names() + "]" : std::string()) << "\n";
+
+    // Store-and-forward is best effort: without a writable spool the client
+    // still runs, it just drops readings taken while disconnected.
+    Spool spool;
+    if (cfg.stream() && cfg.spoolPath != "off" && !spool.open(cfg.spoolPath))
+        std::cerr << "Spool disabled.\n";
+
+    auto local = [&](const char *fallback) { return cfg.localPath.empty() ? std::string(fallback) : cfg.localPath; };
+    auto port  = [&](uint16_t fallback) { return cfg.port ? static_cast<uint16_t>(cfg.port) : fallback; };
+
+    if (cfg.proto == "tcp")
+    {
+        TCPClientSocket sock(cfg.ip, port(8080));
+        return runStream(sock, "TCP", cfg.ip + ":" + std::to_string(port(8080)), sensors, spool,
+                         cfg, source);
+    }
+    if (cfg.proto == "unix")
+    {
+        UnixClientSocket sock(local(kLocalStreamPath));
+        return runStream(sock, "Unix socket", local(kLocalStreamPath), sensors, spool, cfg, source);
+    }
+    if (cfg.proto == "shm")
+    {
+        ShmSocket sock(local(kLocalShmPath));
+        return runStream(sock, "shared memory", local(kLocalShmPath), sensors, spool, cfg, source);
+    }
+    if (cfg.proto == "udp")
+    {
+        UDPClientSocket sock(cfg.ip, port(8081));
+        return runDatagram(sock, "UDP", cfg.ip + ":" + std::to_string(port(8081)), sensors,
+                           cfg, source);
+    }
+    UnixDgramSocket sock(local(kLocalDgramPath));
+    return runDatagram(sock, "Unix datagram", local(kLocalDgramPath), sensors, cfg, source);
 }
 
 int main(int argc, char *argv[])
@@ -391,40 +845,36 @@ int main(int argc, char *argv[])
     // silently dropping every temperature reading.
     std::setlocale(LC_ALL, "C");
 
-    std::signal(SIGINT,  handleSignal);
-    std::signal(SIGTERM, handleSignal);
-
-    std::string proto = "tcp";
-    std::string ip    = "192.168.1.100";
-    int         gpio  = 17;
-
-    for (int i = 1; i < argc; ++i)
+    const ConfigSource source(argc, argv);
+    if (source.help())
     {
-        std::string arg = argv[i];
-        if (arg == "--proto" && i + 1 < argc)
-            proto = argv[++i];
-        else if (arg == "--ip" && i + 1 < argc)
-            ip = argv[++i];
-        else if (arg == "--gpio" && i + 1 < argc)
-            gpio = std::stoi(argv[++i]);
-        else if (arg == "--help")
-        {
-            std::cout << "Usage: iot-client [--proto tcp|udp] [--ip <server_ip>] [--gpio <bcm_pin>]\n";
-            std::cout << "Defaults: --proto tcp  --ip 192.168.1.100  --gpio 17\n";
-            return 0;
-        }
+        std::cout << "Usage: iot-client [--config <file>]\n"
+                     "                  [--proto tcp|udp|unix|unix-dgram|shm] [--ip <server_ip>]\n"
+                     "                  [--port <port>] [--path <socket>] [--gpio <bcm_pin>]\n"
+                     "                  [--spool <file>|off] [--sample-ms <ms>] [--batch-size <n>]\n"
+                     "                  [--deadband <C>] [--heartbeat <s>] [--hysteresis <C>]\n"
+                     "                  [--headless] [--status-interval <s>] [--cpu]\n"
+                     "                  [--tx latency|bulk]\n";
+        std::cout << "Defaults: --config /etc/iot-client/iot-client.conf (KEY=VALUE; flags win)\n"
+                     "          --proto tcp  --ip 192.168.1.100  --port 8080 (UDP 8081)  --gpio 17\n"
+                     "          --path @iot-collector[.dgram|.shm] for the local transports\n"
+                     "          ('@' = abstract socket; anything else is a filesystem path)\n"
+                     "          --spool /var/lib/iot-client/spool.bin  --sample-ms 1000\n"
+                     "          --batch-size 512 (readings per replayed batch, at most 2048)\n"
+                     "          --deadband 0 (answer every poll)  --heartbeat 60  --hysteresis 0.5\n"
+                     "          --status-interval 60 (headless only; implied when stdout is not a TTY)\n"
+                     "          --cpu adds per-core frequency and load average to the sensor frames\n"
+                     "          --tx latency (TCP_NODELAY; bulk lets Nagle coalesce pushed readings)\n"
+                     "SIGHUP or saving the config file reloads it without a restart.\n";
+        return 0;
     }
 
-    if (proto != "tcp" && proto != "udp")
-    {
-        std::cerr << "Invalid protocol. Use tcp or udp.\n";
+    ClientConfig cfg;
+    if (!source.load(cfg))
         return 1;
-    }
-
-    if (proto == "tcp")
-        runTCP(ip, gpio);
-    else
-        runUDP(ip, gpio);
 
+    do
+        setDisplay(cfg.display);
+    while (runClient(cfg, source) == LoopExit::Rebuild);
     return 0;
 }
@@ -0,0 +1,336 @@
+#ifndef IOTPROTO_ASYNCCHANNEL_H
+#define IOTPROTO_ASYNCCHANNEL_H
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  AsyncChannel — co_await-able frame I/O on a Channel (C++20 only).
+//
+//  Lets a device session be written top to bottom instead of as a state
+//  machine spread over fd callbacks:
+//
+//      Task<void> session(AsyncChannel &ch)
+//      {
+//          co_await ch.send("get temp");
+//          FrameResult r = co_await ch.readFrame(5000);
+//          if (!r) co_return;          // timed out, peer gone or error
+//          …
+//      }
+//      spawn(session(ch));
+//
+//  A frame is one protocol line without its newline (one datagram on a
+//  datagram transport). The channel tries the socket first and only
+//  suspends on EAGAIN, registering its fd with the Reactor for just the
+//  direction that is waited on, so an idle session costs a coroutine
+//  frame and nothing in epoll. Any number of sessions share one thread;
+//  each channel allows one reader and one writer at a time.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include "iotproto/Channel.h"
+#include "iotproto/LineFramer.h"
+#include "iotproto/Reactor.h"
+#include "iotproto/Task.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+enum class IoStatus { Ok, Timeout, Closed, Error };
+
+struct FrameResult
+{
+    IoStatus    status = IoStatus::Ok;
+    std::string frame;
+
+    explicit operator bool() const { return status == IoStatus::Ok; }
+};
+
+class AsyncChannel
+{
+public:
+    static constexpr long kNoTimeout = -1;
+
+    AsyncChannel(Reactor &loop, Channel &channel)
+        : m_loop(loop), m_channel(channel) {}
+
+    /** Must not run while a coroutine is suspended in this channel.    */
+    ~AsyncChannel() { detach(); }
+
+    AsyncChannel(const AsyncChannel &)            = delete;
+    AsyncChannel &operator=(const AsyncChannel &) = delete;
+
+    Channel &channel() { return m_channel; }
+
+    /** Next frame, or Timeout after `timeoutMs`, or Closed once the peer
+     *  has gone and every buffered frame has been returned.           */
+    Task<FrameResult> readFrame(long timeoutMs = kNoTimeout)
+    {
+        const auto deadline = deadlineAfter(timeoutMs);
+        for (;;)
+        {
+            if (!m_frames.empty())
+            {
+                FrameResult r { IoStatus::Ok, std::move(m_frames.front()) };
+                m_frames.pop_front();
+                co_return r;
+            }
+            if (m_cancelled || m_eof)
+                co_return FrameResult { IoStatus::Closed, {} };
+
+            Socket *sock = m_channel.channelSocket;
+            if (!sock || sock->fd() < 0)
+                co_return FrameResult { IoStatus::Closed, {} };
+
+            // Shared by every channel on the thread: nothing is kept in it
+            // across a suspension, and coroutine frames stay small.
+            static thread_local char rx[4096];
+            const ssize_t n = sock->read(rx, sizeof(rx));
+            if (n > 0)
+            {
+                append(rx, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == 0)
+            {
+                m_eof = true;
+                continue;
+            }
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                co_return FrameResult { IoStatus::Error, {} };
+
+            const IoStatus st = co_await ready(EPOLLIN, remaining(deadline));
+            if (st != IoStatus::Ok)
+                co_return FrameResult { st, {} };
+        }
+    }
+
+    /** Sends `frame` plus its newline, waiting for socket space as
+     *  needed. Ok once the last byte is handed to the transport.      */
+    Task<IoStatus> send(std::string frame, long timeoutMs = kNoTimeout)
+    {
+        if (!isDatagram())
+            frame += '\n';
+        const auto deadline = deadlineAfter(timeoutMs);
+
+        std::size_t off = 0;
+        while (off < frame.size())
+        {
+            Socket *sock = m_channel.channelSocket;
+            if (m_cancelled || !sock || sock->fd() < 0)
+                co_return IoStatus::Closed;
+
+            const ssize_t n = sock->write(frame.data() + off, frame.size() - off);
+            if (n > 0)
+            {
+                off += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                const IoStatus st = co_await ready(EPOLLOUT, remaining(deadline));
+                if (st != IoStatus::Ok)
+                    co_return st;
+                continue;
+            }
+            co_return (n < 0 && errno == EPIPE) ? IoStatus::Closed : IoStatus::Error;
+        }
+        co_return IoStatus::Ok;
+    }
+
+    /** Wakes a waiting reader and writer with Closed and makes every
+     *  later call return Closed. The Channel itself is left open.     */
+    void cancel()
+    {
+        m_cancelled = true;
+        std::coroutine_handle<> r = take(m_reader, IoStatus::Closed);
+        std::coroutine_handle<> w = take(m_writer, IoStatus::Closed);
+        detach();
+        if (r)
+            r.resume();
+        if (w)
+            w.resume();
+    }
+
+private:
+    using Clock    = std::chrono::steady_clock;
+    using Deadline = std::optional<Clock::time_point>;
+
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;
+        Reactor::TimerId        timer  = 0;
+        IoStatus                result = IoStatus::Ok;
+    };
+
+    /** Suspends until fd() is ready for `event` or `timeoutMs` passes. */
+    struct ReadyAwaiter
+    {
+        AsyncChannel &ch;
+        uint32_t      event;
+        long          timeoutMs;
+
+        bool await_ready() const noexcept { return timeoutMs == 0; }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            Waiter &w = ch.waiter(event);
+            w.handle  = h;
+            w.result  = IoStatus::Ok;
+            if (timeoutMs > 0)
+            {
+                AsyncChannel *self = &ch;
+                const uint32_t ev  = event;
+                w.timer = ch.m_loop.callAfter(timeoutMs, [self, ev] {
+                    self->waiter(ev).timer = 0;        // the loop has dropped it
+                    if (std::coroutine_handle<> r = self->take(self->waiter(ev), IoStatus::Timeout))
+                        r.resume();
+                });
+            }
+            ch.updateInterest();
+        }
+
+        IoStatus await_resume() const noexcept
+        {
+            return timeoutMs == 0 ? IoStatus::Timeout : ch.waiter(event).result;
+        }
+    };
+
+    ReadyAwaiter ready(uint32_t event, long timeoutMs) { return { *this, event, timeoutMs }; }
+
+    Waiter &waiter(uint32_t event) { return event == EPOLLIN ? m_reader : m_writer; }
+
+    bool isDatagram() const
+    {
+        return dynamic_cast<DatagramSocket *>(m_channel.channelSocket) != nullptr;
+    }
+
+    static Deadline deadlineAfter(long timeoutMs)
+    {
+        if (timeoutMs < 0)
+            return std::nullopt;
+        return Clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+
+    static long remaining(const Deadline &deadline)
+    {
+        if (!deadline)
+            return kNoTimeout;
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            *deadline - Clock::now()).count();
+        return std::max<long>(0, static_cast<long>(left));
+    }
+
+    void append(const char *data, std::size_t len)
+    {
+        auto onLine = [this](std::string_view line) { m_frames.emplace_back(line); };
+        m_framer.feed(data, len, onLine);
+        if (isDatagram())
+            m_framer.feed("\n", 1, onLine);    // a datagram ends its last line
+    }
+
+    /** Detaches the waiting coroutine with `status`; the caller resumes
+     *  it once it no longer touches this channel.                     */
+    std::coroutine_handle<> take(Waiter &w, IoStatus status)
+    {
+        if (!w.handle)
+            return {};
+        if (w.timer)
+            m_loop.cancelTimer(w.timer);
+        w.timer  = 0;
+        w.result = status;
+        // Cleared before updateInterest(), or the fd stays watched for a
+        // direction nobody waits on and a level-triggered loop spins.
+        const std::coroutine_handle<> h = std::exchange(w.handle, {});
+        updateInterest();
+        return h;
+    }
+
+    void onEvents(uint32_t events)
+    {
+        std::coroutine_handle<> r, w;
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            r = take(m_reader, IoStatus::Ok);
+        if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+            w = take(m_writer, IoStatus::Ok);
+        // Either may end the session and destroy this channel.
+        if (r)
+            r.resume();
+        if (w)
+            w.resume();
+    }
+
+    /** Watches fd() for exactly the directions someone waits on.       */
+    void updateInterest()
+    {
+        const int fd = m_channel.fd();
+        uint32_t events = 0;
+        if (m_reader.handle)
+            events |= EPOLLIN;
+        if (m_writer.handle)
+            events |= EPOLLOUT;
+
+        if (m_watchedFd >= 0 && (m_watchedFd != fd || events == 0))
+        {
+            m_loop.unwatch(m_watchedFd);
+            m_watchedFd = -1;
+        }
+        if (events == 0 || fd < 0)
+            return;
+        if (m_loop.watch(fd, events, [this](uint32_t ev) { onEvents(ev); }))
+            m_watchedFd = fd;
+    }
+
+    void detach()
+    {
+        for (Waiter *w : { &m_reader, &m_writer })
+        {
+            if (w->timer)
+                m_loop.cancelTimer(w->timer);
+            w->timer = 0;
+        }
+        if (m_watchedFd >= 0)
+            m_loop.unwatch(m_watchedFd);
+        m_watchedFd = -1;
+    }
+
+    Reactor                &m_loop;
+    Channel                &m_channel;
+    LineFramer              m_framer;
+    std::deque<std::string> m_frames;
+    Waiter                  m_reader;
+    Waiter                  m_writer;
+    int                     m_watchedFd = -1;
+    bool                    m_eof       = false;
+    bool                    m_cancelled = false;
+};
+
+struct SleepAwaiter
+{
+    Reactor &loop;
+    long     ms;
+
+    bool await_ready() const noexcept { return ms <= 0; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        loop.callAfter(ms, [h] { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+/** co_await sleepFor(loop, ms): resumes from the loop after `ms`.     */
+inline SleepAwaiter sleepFor(Reactor &loop, long ms) { return { loop, ms }; }
+
+#endif // __cpp_impl_coroutine
+
+#endif // IOTPROTO_ASYNCCHANNEL_H
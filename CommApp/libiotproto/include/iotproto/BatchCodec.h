@@ -0,0 +1,289 @@
+#ifndef IOTPROTO_BATCHCODEC_H
+#define IOTPROTO_BATCHCODEC_H
+
+#include "iotproto/Milli.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if IOTPROTO_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  BatchCodec — compact spool replays ("zbatch").
+//
+//  As "batch" text a replayed reading costs about twenty bytes
+//  ("1792316847329:25.37,"). A steady series barely changes from one
+//  record to the next, so "zbatch" sends the differences instead: the
+//  record count, then per record zigzag(Δ timestamp ms) and
+//  zigzag(Δ millidegrees) as LEB128 varints, which is three or four
+//  bytes for a 1 Hz sensor. The values are Milli already, so the deltas
+//  are exact. The bytes are base64'd so the line protocol stays text.
+//  Builds with liblz4 can run large varint streams through LZ4 as well,
+//  which pays off on long replays where the deltas repeat.
+//
+//    zbatch d <base64>          delta varints
+//    zbatch dl <n> <base64>     delta varints, LZ4-compressed, n raw bytes
+//
+//  The server lists what it decodes in its "session" line (supported());
+//  a client only sends zbatch to a server that listed it.
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace batchcodec
+{
+
+struct Record
+{
+    int64_t timestampMs = 0;
+    Milli   value;
+};
+
+inline constexpr std::string_view kDelta    = "d";
+inline constexpr std::string_view kDeltaLz4 = "dl";
+
+/** Varint streams at least this long are worth trying LZ4 on.         */
+inline constexpr std::size_t kLz4MinBytes = 512;
+
+/** Upper bound on a decoded stream; a bad "dl" length cannot make the
+ *  receiver allocate more than this.                                  */
+inline constexpr std::size_t kMaxRawBytes = 1 << 20;
+
+inline constexpr bool haveLz4()
+{
+#if IOTPROTO_HAVE_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+/** Codecs this build decodes, as listed in "session".                */
+inline std::string supported()
+{
+    std::string s(kDelta);
+    if (haveLz4())
+        s += "," + std::string(kDeltaLz4);
+    return s;
+}
+
+/** Whether the comma-separated `list` names `codec`.                 */
+inline bool listed(std::string_view list, std::string_view codec)
+{
+    while (!list.empty())
+    {
+        const std::size_t comma = list.find(',');
+        if (list.substr(0, comma) == codec)
+            return true;
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// ── Varints ──────────────────────────────────────────────────────────────────
+
+inline uint64_t zigzag(int64_t v)   { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t  unzigzag(uint64_t u) { return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1); }
+
+inline void putVarint(std::string &out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline bool getVarint(std::string_view &in, uint64_t &v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7)
+    {
+        const auto b = static_cast<uint8_t>(in.front());
+        in.remove_prefix(1);
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline std::string encodeDeltas(const std::vector<Record> &records)
+{
+    std::string out;
+    out.reserve(2 + records.size() * 4);
+    putVarint(out, records.size());
+    int64_t prevTs = 0, prevMilli = 0;
+    for (const Record &r : records)
+    {
+        putVarint(out, zigzag(r.timestampMs - prevTs));
+        putVarint(out, zigzag(r.value.raw - prevMilli));
+        prevTs    = r.timestampMs;
+        prevMilli = r.value.raw;
+    }
+    return out;
+}
+
+inline bool decodeDeltas(std::string_view in, std::vector<Record> &out)
+{
+    out.clear();
+    uint64_t count = 0;
+    if (!getVarint(in, count) || count > in.size() / 2)
+        return false;                       // two bytes per record at least
+    out.reserve(static_cast<std::size_t>(count));
+    int64_t ts = 0, milli = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t dt, dv;
+        if (!getVarint(in, dt) || !getVarint(in, dv))
+            return false;
+        // Deltas come straight off the wire: a corrupt or hostile batch
+        // must not overflow the running sums.
+        if (__builtin_add_overflow(ts, unzigzag(dt), &ts)
+            || __builtin_add_overflow(milli, unzigzag(dv), &milli)
+            || milli < INT32_MIN || milli > INT32_MAX)
+            return false;
+        out.push_back({ ts, Milli::fromRaw(static_cast<int32_t>(milli)) });
+    }
+    return in.empty();
+}
+
+// ── Base64 (RFC 4648, padded) ────────────────────────────────────────────────
+
+inline std::string base64Encode(std::string_view in)
+{
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((in.size() + 2) / 3 * 4);
+    std::size_t i = 0;
+    for (; i + 2 < in.size(); i += 3)
+    {
+        const uint32_t n = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8) | uint8_t(in[i + 2]);
+        out += { kAlphabet[n >> 18], kAlphabet[(n >> 12) & 63],
+                 kAlphabet[(n >> 6) & 63], kAlphabet[n & 63] };
+    }
+    if (i + 1 == in.size())
+    {
+        const uint32_t n = uint8_t(in[i]) << 16;
+        out += { kAlphabet[n >> 18], kAlphabet[(n >> 12) & 63], '=', '=' };
+    }
+    else if (i + 2 == in.size())
+    {
+        const uint32_t n = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8);
+        out += { kAlphabet[n >> 18], kAlphabet[(n >> 12) & 63], kAlphabet[(n >> 6) & 63], '=' };
+    }
+    return out;
+}
+
+inline bool base64Decode(std::string_view in, std::string &out)
+{
+    auto sextet = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    out.clear();
+    if (in.size() % 4 != 0)
+        return false;
+    out.reserve(in.size() / 4 * 3);
+    for (std::size_t i = 0; i < in.size(); i += 4)
+    {
+        const int a = sextet(in[i]), b = sextet(in[i + 1]);
+        const bool last = i + 4 == in.size();
+        const int c = (last && in[i + 2] == '=') ? 0 : sextet(in[i + 2]);
+        const int d = (last && in[i + 3] == '=') ? 0 : sextet(in[i + 3]);
+        if (a < 0 || b < 0 || c < 0 || d < 0)
+            return false;
+        const uint32_t n = (a << 18) | (b << 12) | (c << 6) | d;
+        out.push_back(static_cast<char>(n >> 16));
+        if (!(last && in[i + 2] == '='))
+            out.push_back(static_cast<char>((n >> 8) & 0xFF));
+        if (!(last && in[i + 3] == '='))
+            out.push_back(static_cast<char>(n & 0xFF));
+    }
+    return true;
+}
+
+// ── zbatch lines ─────────────────────────────────────────────────────────────
+
+#if IOTPROTO_HAVE_LZ4
+/** "<n> <base64>" → the n-byte varint stream.                         */
+inline bool decodeLz4(std::string_view args, std::string &raw)
+{
+    const std::size_t sp = args.find(' ');
+    if (sp == std::string_view::npos)
+        return false;
+    std::size_t rawLen = 0;
+    for (char c : args.substr(0, sp))
+    {
+        if (c < '0' || c > '9' || rawLen > kMaxRawBytes)
+            return false;
+        rawLen = rawLen * 10 + static_cast<std::size_t>(c - '0');
+    }
+    std::string packed;
+    if (rawLen == 0 || rawLen > kMaxRawBytes || !base64Decode(args.substr(sp + 1), packed))
+        return false;
+    raw.resize(rawLen);
+    const int n = LZ4_decompress_safe(packed.data(), raw.data(),
+                                      static_cast<int>(packed.size()),
+                                      static_cast<int>(rawLen));
+    return n >= 0 && static_cast<std::size_t>(n) == rawLen;
+}
+#endif
+
+/** Arguments of a "zbatch" line for `records` (no keyword, no newline).
+ *  LZ4 is used if `lz4` allows it and it actually saves bytes.       */
+inline std::string encode(const std::vector<Record> &records, bool lz4)
+{
+    const std::string raw = encodeDeltas(records);
+#if IOTPROTO_HAVE_LZ4
+    if (lz4 && raw.size() >= kLz4MinBytes && raw.size() <= kMaxRawBytes)
+    {
+        std::string packed(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(raw.size()))), '\0');
+        const int n = LZ4_compress_default(raw.data(), packed.data(),
+                                           static_cast<int>(raw.size()),
+                                           static_cast<int>(packed.size()));
+        if (n > 0 && static_cast<std::size_t>(n) < raw.size())
+        {
+            packed.resize(static_cast<std::size_t>(n));
+            return std::string(kDeltaLz4) + " " + std::to_string(raw.size()) + " "
+                 + base64Encode(packed);
+        }
+    }
+#else
+    (void)lz4;
+#endif
+    return std::string(kDelta) + " " + base64Encode(raw);
+}
+
+/** Decodes the arguments of a "zbatch" line into `out`. False (and
+ *  nothing decoded) on an unknown codec or a damaged payload.        */
+inline bool decode(std::string_view codec, std::string_view args, std::vector<Record> &out)
+{
+    std::string raw;
+    bool ok = false;
+    if (codec == kDelta)
+        ok = base64Decode(args, raw) && decodeDeltas(raw, out);
+#if IOTPROTO_HAVE_LZ4
+    else if (codec == kDeltaLz4)
+        ok = decodeLz4(args, raw) && decodeDeltas(raw, out);
+#endif
+    if (!ok)
+        out.clear();
+    return ok;
+}
+
+} // namespace batchcodec
+
+#endif // IOTPROTO_BATCHCODEC_H
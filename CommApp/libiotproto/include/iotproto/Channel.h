@@ -0,0 +1,160 @@
+#ifndef IOTPROTO_CHANNEL_H
+#define IOTPROTO_CHANNEL_H
+
+#include "iotproto/Socket.h"
+#include "iotproto/UnixSocket.h"
+#include "iotproto/ShmSocket.h"
+#include "iotproto/UringSocket.h"
+
+#include <memory>
+#include <string>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Transport selection. TCP/UDP reach the collector over the network; the
+//  local transports skip the IP stack for agents on the collector's host.
+//  TcpUring is TCP served through io_uring; where that is not compiled in
+//  or the kernel refuses it, select() falls back to plain TCP.
+// ─────────────────────────────────────────────────────────────────────────────
+enum class Transport { Tcp, Udp, UnixStream, UnixDgram, Shm, TcpUring };
+
+/** Whether `t` is connection-oriented (StreamSocket) or datagram based. */
+inline bool isStream(Transport t)
+{
+    return t != Transport::Udp && t != Transport::UnixDgram;
+}
+
+inline const char *transportName(Transport t)
+{
+    switch (t)
+    {
+    case Transport::Tcp:        return "TCP";
+    case Transport::Udp:        return "UDP";
+    case Transport::UnixStream: return "Unix stream";
+    case Transport::UnixDgram:  return "Unix datagram";
+    case Transport::Shm:        return "shared memory";
+    case Transport::TcpUring:   return "TCP (io_uring)";
+    }
+    return "?";
+}
+
+class Channel
+{
+public:
+    Socket *channelSocket = nullptr;
+
+    virtual ~Channel() = default;
+
+    virtual void start() = 0;
+    virtual void stop() = 0;
+    virtual void send(const std::string &message) = 0;
+    virtual void receive() = 0;
+
+    int fd() const { return channelSocket ? channelSocket->fd() : -1; }
+};
+
+class ServerChannel : public Channel
+{
+public:
+    /** Replaces channelSocket with a new, not yet listening server socket
+     *  for `t`. `path` overrides the default address of a local transport. */
+    Socket *select(Transport t, const std::string &path = {})
+    {
+        switch (t)
+        {
+        case Transport::Tcp:        m_owned = std::make_unique<TCPSocket>(); break;
+        case Transport::Udp:        m_owned = std::make_unique<UDPSocket>(); break;
+        case Transport::UnixStream:
+            m_owned = std::make_unique<UnixStreamSocket>(path.empty() ? kLocalStreamPath : path);
+            break;
+        case Transport::UnixDgram:
+            m_owned = std::make_unique<UnixDgramSocket>(path.empty() ? kLocalDgramPath : path);
+            break;
+        case Transport::Shm:
+            m_owned = std::make_unique<ShmSocket>(path.empty() ? kLocalShmPath : path);
+            break;
+        case Transport::TcpUring:
+#if IOTPROTO_HAVE_URING
+            if (UringTcpSocket::available())
+            {
+                m_owned = std::make_unique<UringTcpSocket>();
+                break;
+            }
+#endif
+            std::cerr << "[ServerChannel] io_uring unavailable, using epoll TCP\n";
+            t = Transport::Tcp;
+            m_owned = std::make_unique<TCPSocket>();
+            break;
+        }
+        m_transport   = t;
+        channelSocket = m_owned.get();
+        return channelSocket;
+    }
+
+    /** What select() actually set up (see Transport::TcpUring).        */
+    Transport transport() const { return m_transport; }
+
+    /** The selected socket through its stream or datagram interface;
+     *  nullptr if the transport is of the other kind.                  */
+    StreamSocket   *stream() const   { return dynamic_cast<StreamSocket *>(channelSocket); }
+    DatagramSocket *datagram() const { return dynamic_cast<DatagramSocket *>(channelSocket); }
+
+    void start() override
+    {
+        if (channelSocket)
+            channelSocket->waitForConnect();
+    }
+
+    int startListening()
+    {
+        if (!channelSocket)
+            return -1;
+        return channelSocket->waitForConnect();
+    }
+
+    void stop() override
+    {
+        if (channelSocket)
+            channelSocket->shutdown();
+    }
+    void send(const std::string &msg) override
+    {
+        if (channelSocket)
+            channelSocket->send(msg);
+    }
+    void receive() override
+    {
+        if (channelSocket)
+            channelSocket->receive();
+    }
+
+private:
+    std::unique_ptr<Socket> m_owned;
+    Transport               m_transport = Transport::Tcp;
+};
+
+class ClientChannel : public Channel
+{
+public:
+    void start() override
+    {
+        if (channelSocket)
+            channelSocket->connect();
+    }
+    void stop() override
+    {
+        if (channelSocket)
+            channelSocket->shutdown();
+    }
+    void send(const std::string &msg) override
+    {
+        if (channelSocket)
+            channelSocket->send(msg);
+    }
+    void receive() override
+    {
+        if (channelSocket)
+            channelSocket->receive();
+    }
+};
+
+#endif // IOTPROTO_CHANNEL_H
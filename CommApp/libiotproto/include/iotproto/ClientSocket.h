@@ -0,0 +1,279 @@
+#ifndef IOTPROTO_CLIENTSOCKET_H
+#define IOTPROTO_CLIENTSOCKET_H
+
+#include "iotproto/Socket.h"
+#include "iotproto/UnixSocket.h"
+
+#include <cerrno>
+#include <string>
+#include <utility>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Client-side transports for an epoll loop: non-blocking connect, a send
+//  queue drained on EPOLLOUT (TCP, Unix stream) and non-blocking datagram
+//  receive (UDP). UnixDgramSocket and ShmSocket serve both sides as-is.
+// ─────────────────────────────────────────────────────────────────────────────
+
+/** Non-blocking stream client with a send queue. Subclasses only say how
+ *  to open the socket; the connect/flush/read cycle is shared.          */
+class StreamClientSocket : public Socket
+{
+private:
+    int         m_fd = -1;
+    std::string m_txBuf;
+
+protected:
+    /** Creates a non-blocking socket and starts connecting it. Returns
+     *  the fd, or -1 on an immediate failure.                           */
+    virtual int openConnection() = 0;
+
+public:
+    ~StreamClientSocket() override { shutdown(); }
+
+    /** Server-side entry point; a client socket never listens.         */
+    int waitForConnect() override { return -1; }
+
+    /** Starts a non-blocking connect so the event loop keeps running while
+     *  the SYN is in flight. Returns 0 if the connect completed or is in
+     *  progress (wait for EPOLLOUT, then call finishConnect()), -1 on an
+     *  immediate failure.                                                */
+    int connect() override
+    {
+        m_txBuf.clear();
+        m_fd = openConnection();
+
+        // FIX (Bug 7): Socket::connect() contract is 0 on success / -1 on
+        // failure. The original returned m_fd (e.g. 4), which works with the
+        // >= 0 check but violates the interface and breaks any == 0 check.
+        return m_fd >= 0 ? 0 : -1;
+    }
+
+    /** Result of the non-blocking connect once the fd turned writable:
+     *  0 on success, otherwise the socket error (errno value).          */
+    int finishConnect()
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+            return errno;
+        return err;
+    }
+
+    /** Queues the message and writes as much as the kernel accepts right
+     *  now; call flush() on EPOLLOUT for the rest.                      */
+    void send(const std::string &message) override
+    {
+        if (m_fd < 0)
+            return;
+        m_txBuf += message;
+        flush();
+    }
+
+    /** Write out queued bytes. Returns false on a hard socket error.
+     *  FIX: MSG_NOSIGNAL prevents SIGPIPE from killing the process when
+     *  the server has already closed the connection.                    */
+    bool flush()
+    {
+        std::size_t off = 0;
+        while (off < m_txBuf.size())
+        {
+            ssize_t n = ::send(m_fd, m_txBuf.data() + off, m_txBuf.size() - off, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (n <= 0)
+            {
+                m_txBuf.clear();
+                return false;
+            }
+            off += static_cast<std::size_t>(n);
+        }
+        m_txBuf.erase(0, off);
+        return true;
+    }
+
+    std::size_t pendingBytes() const { return m_txBuf.size(); }
+
+    /** Unqueued write: EAGAIN while earlier send()s are still pending, so
+     *  bytes never overtake the queue.                                  */
+    ssize_t write(const char *data, std::size_t len) override
+    {
+        if (!flush())
+        {
+            errno = EPIPE;
+            return -1;
+        }
+        if (!m_txBuf.empty())
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        return ::send(m_fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    void receive() override
+    {
+        char buf[1024];
+        ssize_t n = read(buf, sizeof(buf) - 1);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            std::cout << "[Client] Received: " << buf << "\n";
+        }
+    }
+
+    void shutdown() override
+    {
+        m_txBuf.clear();
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    int fd() const override { return m_fd; }
+};
+
+class TCPClientSocket : public StreamClientSocket
+{
+private:
+    std::string m_ip;
+    uint16_t    m_port;
+
+protected:
+    int openConnection() override
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return -1;
+
+        struct sockaddr_in addr{};
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(m_port);
+        if (::inet_pton(AF_INET, m_ip.c_str(), &addr.sin_addr) != 1)
+        {
+            ::close(fd);
+            return -1;
+        }
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+            && errno != EINPROGRESS)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+public:
+    TCPClientSocket(const std::string &ip, uint16_t port)
+        : m_ip(ip), m_port(port) {}
+
+    /** See TxMode.                                                      */
+    bool setTxMode(TxMode mode) { return ::setTxMode(fd(), mode); }
+};
+
+/** Stream client for a collector on the same host. An AF_UNIX connect
+ *  never goes EINPROGRESS: it either completes or fails on the spot.  */
+class UnixClientSocket : public StreamClientSocket
+{
+private:
+    std::string m_path;
+
+protected:
+    int openConnection() override
+    {
+        sockaddr_un addr;
+        socklen_t   len = 0;
+        if (!unixAddress(m_path, addr, len))
+            return -1;
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return -1;
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), len) < 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+public:
+    explicit UnixClientSocket(std::string path = kLocalStreamPath)
+        : m_path(std::move(path)) {}
+};
+
+class UDPClientSocket : public UDPSocket
+{
+private:
+    std::string        m_ip;
+    uint16_t           m_port;
+    int                m_fd = -1;
+    struct sockaddr_in m_serverAddr{};
+
+public:
+    UDPClientSocket(const std::string &ip, uint16_t port)
+        : m_ip(ip), m_port(port)
+    {
+        std::memset(&m_serverAddr, 0, sizeof(m_serverAddr));
+    }
+
+    int connect() override
+    {
+        m_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_fd < 0)
+            return -1;
+
+        std::memset(&m_serverAddr, 0, sizeof(m_serverAddr));
+        m_serverAddr.sin_family = AF_INET;
+        m_serverAddr.sin_port   = htons(m_port);
+        if (::inet_pton(AF_INET, m_ip.c_str(), &m_serverAddr.sin_addr) != 1)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+            return -1;
+        }
+
+        // FIX (Bug 7): return 0 on success to match Socket::connect() contract.
+        return 0;
+    }
+
+    void send(const std::string &message) override
+    {
+        if (m_fd < 0)
+            return;
+        ::sendto(m_fd, message.c_str(), message.size(), 0,
+                 reinterpret_cast<const sockaddr *>(&m_serverAddr),
+                 sizeof(m_serverAddr));
+    }
+
+    /** Non-blocking: returns an empty string once the queue is drained. */
+    std::string receiveFrom() override
+    {
+        char buf[256] = {};
+        struct sockaddr_in from{};
+        socklen_t fromLen = sizeof(from);
+        int n = ::recvfrom(m_fd, buf, sizeof(buf) - 1, 0,
+                           reinterpret_cast<sockaddr *>(&from), &fromLen);
+        if (n <= 0)
+            return {};
+        buf[n] = '\0';
+        return std::string(buf);
+    }
+
+    void shutdown() override
+    {
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    int fd() const override { return m_fd; }
+};
+
+#endif // IOTPROTO_CLIENTSOCKET_H
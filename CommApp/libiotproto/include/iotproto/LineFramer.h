@@ -0,0 +1,74 @@
+#ifndef IOTPROTO_LINEFRAMER_H
+#define IOTPROTO_LINEFRAMER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  LineFramer — splits a TCP byte stream into protocol lines.
+//
+//  feed() appends what recv() returned and hands every complete line to the
+//  callback as a string_view into the buffer (CR stripped, empty lines
+//  skipped). The consumed prefix is erased once per feed() rather than once
+//  per line, so a recv() carrying a burst of lines costs one memmove.
+//  The views are only valid inside the callback.
+// ─────────────────────────────────────────────────────────────────────────────
+class LineFramer
+{
+public:
+    /** Lines longer than this are dropped whole: once the buffer passes
+     *  it, input is discarded up to the next newline, so a peer that never
+     *  sends one cannot grow the buffer and the tail of the line is not
+     *  mistaken for a line of its own.                                  */
+    static constexpr std::size_t kMaxLine = 64 * 1024;
+
+    template <typename Fn>
+    void feed(const char *data, std::size_t len, Fn &&onLine)
+    {
+        if (m_discarding)
+        {
+            const void *nl = std::memchr(data, '\n', len);
+            if (!nl)
+                return;
+            m_discarding = false;
+            const std::size_t skip = static_cast<const char *>(nl) - data + 1;
+            data += skip;
+            len  -= skip;
+        }
+        m_buf.append(data, len);
+
+        std::size_t start = 0;
+        std::size_t nl;
+        while ((nl = m_buf.find('\n', start)) != std::string::npos)
+        {
+            std::string_view line(m_buf.data() + start, nl - start);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (!line.empty())
+                onLine(line);
+            start = nl + 1;
+        }
+        m_buf.erase(0, start);
+
+        if (m_buf.size() > kMaxLine)
+        {
+            m_buf.clear();
+            m_discarding = true;
+        }
+    }
+
+    void clear()
+    {
+        m_buf.clear();
+        m_discarding = false;
+    }
+    std::size_t buffered() const { return m_buf.size(); }
+
+private:
+    std::string m_buf;
+    bool        m_discarding = false;   // inside an over-long line
+};
+
+#endif // IOTPROTO_LINEFRAMER_H
@@ -0,0 +1,150 @@
+#ifndef IOTPROTO_MILLI_H
+#define IOTPROTO_MILLI_H
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Milli — a reading as a whole number of thousandths of its unit.
+//
+//  The sensors report integers: sysfs temperatures in millidegrees, CPU
+//  frequency in kHz (thousandths of the "cpu<N>.mhz" channel) and
+//  /proc/loadavg to three decimals. Milli carries that integer end to
+//  end — sample, LED logic, frame, threshold, history store, alert
+//  rules — so a comparison at the threshold is exact and every copy of a
+//  reading is the same number, where a double picked up a different last
+//  digit at each ostringstream / toDouble round trip.
+//
+//  On the wire a Milli is plain decimal text ("25.375", "-0.5", "42"),
+//  which peers that still parse doubles read unchanged; toChars() and
+//  parse() convert without going through floating point. toDouble() is
+//  for the UI edge — gauge, chart, fleet table — and nothing else.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct Milli
+{
+    int32_t raw = 0;                    // thousandths
+
+    /** Longest toChars() output: "-2147483.648".                       */
+    static constexpr std::size_t kMaxChars = 12;
+
+    static constexpr Milli fromRaw(int32_t raw) { return Milli { raw }; }
+    static constexpr Milli fromUnits(int32_t units) { return Milli { units * 1000 }; }
+    static Milli fromDouble(double v) { return Milli { static_cast<int32_t>(std::lround(v * 1000.0)) }; }
+
+    constexpr double toDouble() const { return raw / 1000.0; }
+
+    /** Writes the shortest decimal form (no trailing zeros, no NUL) at
+     *  `first`, which must have kMaxChars of room; returns the end.     */
+    char *toChars(char *first) const
+    {
+        int64_t v = raw;
+        if (v < 0)
+        {
+            *first++ = '-';
+            v = -v;
+        }
+        char *p = std::to_chars(first, first + kMaxChars, v / 1000).ptr;
+        int frac = static_cast<int>(v % 1000);
+        if (frac != 0)
+        {
+            *p++ = '.';
+            for (int div = 100; frac != 0; div /= 10)
+            {
+                *p++ = static_cast<char>('0' + frac / div);
+                frac %= div;
+            }
+        }
+        return p;
+    }
+
+    std::string toString() const
+    {
+        char buf[kMaxChars];
+        return std::string(buf, toChars(buf));
+    }
+
+    /** Decimal text with an optional sign and any number of fractional
+     *  digits; past the third they round half away from zero. Exponent
+     *  forms ("2.4e+06", which ostringstream writes for large values)
+     *  are taken through double. False on junk or out of range.       */
+    static bool parse(std::string_view s, Milli &out)
+    {
+        const char *p   = s.data();
+        const char *end = p + s.size();
+        bool neg = false;
+        if (p != end && (*p == '-' || *p == '+'))
+            neg = *p++ == '-';
+
+        int64_t v = 0;
+        int     digits = 0, fracDigits = 0;
+        bool    roundUp = false;
+        for (; p != end && *p >= '0' && *p <= '9'; ++p, ++digits)
+        {
+            v = v * 10 + (*p - '0');
+            if (v > kLimit)
+                return false;
+        }
+        if (p != end && *p == '.')
+        {
+            for (++p; p != end && *p >= '0' && *p <= '9'; ++p, ++digits)
+            {
+                if (fracDigits < 3)
+                    v = v * 10 + (*p - '0'), ++fracDigits;
+                else if (fracDigits++ == 3)
+                    roundUp = *p >= '5';
+            }
+        }
+        if (digits == 0)
+            return false;
+        if (p != end)
+            return parseExponent(s, out);
+
+        for (; fracDigits < 3; ++fracDigits)
+            v *= 10;
+        v += roundUp;
+        if (v > kLimit)
+            return false;
+        out.raw = static_cast<int32_t>(neg ? -v : v);
+        return true;
+    }
+
+    friend constexpr bool  operator==(Milli a, Milli b) { return a.raw == b.raw; }
+    friend constexpr bool  operator!=(Milli a, Milli b) { return a.raw != b.raw; }
+    friend constexpr bool  operator< (Milli a, Milli b) { return a.raw <  b.raw; }
+    friend constexpr bool  operator<=(Milli a, Milli b) { return a.raw <= b.raw; }
+    friend constexpr bool  operator> (Milli a, Milli b) { return a.raw >  b.raw; }
+    friend constexpr bool  operator>=(Milli a, Milli b) { return a.raw >= b.raw; }
+    friend constexpr Milli operator+ (Milli a, Milli b) { return Milli { a.raw + b.raw }; }
+    friend constexpr Milli operator- (Milli a, Milli b) { return Milli { a.raw - b.raw }; }
+
+    friend std::ostream &operator<<(std::ostream &os, Milli m)
+    {
+        char buf[kMaxChars];
+        return os.write(buf, m.toChars(buf) - buf);
+    }
+
+private:
+    static constexpr int64_t kLimit = INT32_MAX;
+
+    static bool parseExponent(std::string_view s, Milli &out)
+    {
+        if (!s.empty() && s.front() == '+')
+            s.remove_prefix(1);
+        double d = 0.0;
+        const char *end = s.data() + s.size();
+        auto [ptr, ec]  = std::from_chars(s.data(), end, d);
+        if (ec != std::errc() || ptr != end || !(std::fabs(d) * 1000.0 <= kLimit))
+            return false;
+        out = fromDouble(d);
+        return true;
+    }
+};
+
+#endif // IOTPROTO_MILLI_H
@@ -0,0 +1,547 @@
+#ifndef IOTPROTO_PROTOCOL_H
+#define IOTPROTO_PROTOCOL_H
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Protocol.h — the line protocol between iot-client and the server.
+//
+//  Part of libiotproto, used by both sides. Every command is declared once
+//  below: its keyword, its argument type and how the argument is parsed.
+//  dispatch() finds the command with a perfect hash built at compile
+//  time, parses the arguments in place (string_view + from_chars, no
+//  allocation) and calls the handler's operator() for that command type.
+//  A side simply does not provide an operator() for the commands it never
+//  receives.
+//
+//    server → client   set threshold <C>      get temp
+//                      set config <key>=<value> …
+//                      session <token> <n> [<codec>,…]
+//                      sync <ms>
+//    client → server   <C> [@<ms>]            batch <ms>:<C>,<ms>:<C>,…
+//                      zbatch <codec> …       (BatchCodec.h)
+//                      frame <v0>,<v1>,… [@<ms>]
+//                      channels <name>,…      mode push | poll | ids
+//                      resume [<token>]       synced <ms> <ms>
+//
+//  Tags: a client that sent "mode ids" may be sent any server command as
+//  "#<id> <command>", and answers each one with "#<id> <reply>" — the
+//  reading for "get temp", "ok" or "err" otherwise. The server can then
+//  keep several commands outstanding and match the answers as they come;
+//  untagged commands still work as before.
+//
+//  Readings and thresholds are Milli (Milli.h): decimal text on the wire,
+//  fixed-point thousandths once parsed.
+//
+//  Time: a client that has answered "sync" stamps readings with its own
+//  monotonic clock ("@<ms>", and the batch timestamps); the server maps
+//  them onto its clock with the offset and drift it estimates from the
+//  sync exchanges. Before that, readings are unstamped and batch
+//  timestamps are wall-clock milliseconds.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "iotproto/Milli.h"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace proto
+{
+
+// ── Argument parsing ─────────────────────────────────────────────────────────
+
+inline std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+        s.remove_suffix(1);
+    return s;
+}
+
+/** Whole-field number parse; false on junk, trailing text or empty.  */
+template <typename T>
+inline bool parseNumber(std::string_view s, T &out)
+{
+    s = trim(s);
+    if (!s.empty() && s.front() == '+')
+        s.remove_prefix(1);
+    const char *end = s.data() + s.size();
+    auto [ptr, ec]  = std::from_chars(s.data(), end, out);
+    return !s.empty() && ec == std::errc() && ptr == end;
+}
+
+/** Readings go through Milli's own parser, not floating point.       */
+inline bool parseNumber(std::string_view s, Milli &out)
+{
+    return Milli::parse(trim(s), out);
+}
+
+/** Calls fn(index, field) for every comma-separated field.           */
+template <typename Fn>
+inline void forEachField(std::string_view list, Fn &&fn)
+{
+    std::size_t index = 0;
+    while (true)
+    {
+        const std::size_t comma = list.find(',');
+        fn(index++, list.substr(0, comma));
+        if (comma == std::string_view::npos)
+            return;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+/** Strips a trailing " @<ms>" sample stamp off `args` into `stampMs`;
+ *  false (and `args` untouched) if there is none.                   */
+inline bool splitStamp(std::string_view &args, int64_t &stampMs)
+{
+    const std::string_view t = trim(args);
+    const std::size_t at = t.rfind('@');
+    if (at == std::string_view::npos || !parseNumber(t.substr(at + 1), stampMs))
+        return false;
+    args = trim(t.substr(0, at));
+    return true;
+}
+
+// ── Tags ─────────────────────────────────────────────────────────────────────
+
+/** Answers to a tagged command that has no reading to return.        */
+inline constexpr std::string_view kReplyOk  = "ok";
+inline constexpr std::string_view kReplyErr = "err";
+
+/** Strips a leading "#<id> " off `line` into `id`; false (and `line`
+ *  untouched) if it is not tagged.                                  */
+inline bool splitTag(std::string_view &line, uint32_t &id)
+{
+    const std::string_view t = trim(line);
+    if (t.size() < 2 || t.front() != '#' || t[1] < '0' || t[1] > '9')
+        return false;
+    const std::size_t sp = t.find(' ');
+    if (!parseNumber(t.substr(1, sp == std::string_view::npos ? sp : sp - 1), id))
+        return false;
+    line = sp == std::string_view::npos ? std::string_view() : trim(t.substr(sp + 1));
+    return true;
+}
+
+/** "#<id> <line>" (no newline).                                      */
+inline std::string tag(uint32_t id, std::string_view line)
+{
+    std::string out = "#" + std::to_string(id) + " ";
+    out.append(line.data(), line.size());
+    return out;
+}
+
+// ── Commands ─────────────────────────────────────────────────────────────────
+
+/** "set threshold <C>" — new LED threshold.                          */
+struct SetThreshold
+{
+    static constexpr std::string_view keyword = "set threshold";
+    Milli value;
+
+    static bool parse(std::string_view args, SetThreshold &out)
+    { return parseNumber(args, out.value); }
+};
+
+/** "set config <key>=<value> …" — re-tunes a running client (sample
+ *  rate, deadband, replay batch size, …) without restarting it. Keys
+ *  are the client's config file keys in lower case; the client applies
+ *  all of them or, if one is unknown or invalid, none.               */
+struct SetConfig
+{
+    static constexpr std::string_view keyword = "set config";
+    std::string_view settings;
+
+    static bool parse(std::string_view args, SetConfig &out)
+    {
+        out.settings = trim(args);
+        bool ok = !out.settings.empty();
+        out.forEach([&](std::string_view key, std::string_view) { ok = ok && !key.empty(); });
+        return ok;
+    }
+
+    /** Calls fn(key, value) for every space-separated "key=value"; an
+     *  item without '=' comes through with an empty key.              */
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        std::string_view rest = settings;
+        while (!rest.empty())
+        {
+            const std::size_t sp = rest.find(' ');
+            const std::string_view item = rest.substr(0, sp);
+            const std::size_t eq = item.find('=');
+            if (eq == std::string_view::npos)
+                fn(std::string_view(), item);
+            else
+                fn(item.substr(0, eq), item.substr(eq + 1));
+            rest = sp == std::string_view::npos ? std::string_view() : trim(rest.substr(sp + 1));
+        }
+    }
+};
+
+/** "get temp" — poll for the current reading.                        */
+struct GetTemp
+{
+    static constexpr std::string_view keyword = "get temp";
+
+    static bool parse(std::string_view args, GetTemp &)
+    { return trim(args).empty(); }
+};
+
+/** "batch <ms>:<C>,…" — spooled readings, replayed after a reconnect. */
+struct Batch
+{
+    static constexpr std::string_view keyword = "batch";
+    std::string_view payload;
+
+    static bool parse(std::string_view args, Batch &out)
+    { out.payload = args; return true; }
+
+    /** Calls fn(timestampMs, value) for every well-formed item.       */
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        forEachField(payload, [&](std::size_t, std::string_view item)
+        {
+            const std::size_t colon = item.find(':');
+            int64_t ts = 0;
+            Milli   v;
+            if (colon != std::string_view::npos
+                && parseNumber(item.substr(0, colon), ts)
+                && parseNumber(item.substr(colon + 1), v))
+                fn(ts, v);
+        });
+    }
+};
+
+/** "frame <v0>,<v1>,… [@<ms>]" — one sampling pass over all channels. */
+struct Frame
+{
+    static constexpr std::string_view keyword = "frame";
+    std::string_view payload;
+    int64_t          stampMs = 0;
+    bool             stamped = false;
+
+    static bool parse(std::string_view args, Frame &out)
+    {
+        out.stamped = splitStamp(args, out.stampMs);
+        out.payload = args;
+        return true;
+    }
+
+    /** Calls fn(channelIndex, value); unparsable fields are skipped but
+     *  keep their position.                                          */
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        forEachField(payload, [&](std::size_t i, std::string_view field)
+        {
+            Milli v;
+            if (parseNumber(field, v))
+                fn(i, v);
+        });
+    }
+};
+
+/** "channels <name>,…" — layout of the frames that follow.           */
+struct Channels
+{
+    static constexpr std::string_view keyword = "channels";
+    std::string_view names;
+
+    static bool parse(std::string_view args, Channels &out)
+    { out.names = trim(args); return true; }
+};
+
+/** "mode push" — the client reports on its own; stop polling.
+ *  "mode poll" — it no longer does (its deadband was set back to 0).
+ *  "mode ids"  — the client answers tagged commands (see Tags).       */
+struct Mode
+{
+    static constexpr std::string_view keyword = "mode";
+    std::string_view mode;
+
+    static bool parse(std::string_view args, Mode &out)
+    { out.mode = trim(args); return !out.mode.empty(); }
+};
+
+/** "resume [<token>]" — first line of a stream client: carry on with
+ *  the session the server handed out before, or start a new one.     */
+struct Resume
+{
+    static constexpr std::string_view keyword = "resume";
+    std::string_view token;                     // empty: new session
+
+    static bool parse(std::string_view args, Resume &out)
+    {
+        out.token = trim(args);
+        return out.token.find(' ') == std::string_view::npos;
+    }
+};
+
+/** "session <token> <n> [<codec>,…]" — the answer to "resume": the
+ *  session now in effect (a new token if the old one was unknown or
+ *  expired), how many batch items the server already holds from it and
+ *  the "zbatch" codecs it decodes.                                   */
+struct Session
+{
+    static constexpr std::string_view keyword = "session";
+    std::string_view token;
+    uint64_t         records = 0;
+    std::string_view codecs;                    // empty: text batches only
+
+    static bool parse(std::string_view args, Session &out)
+    {
+        args = trim(args);
+        const std::size_t sp = args.find(' ');
+        if (sp == std::string_view::npos)
+            return false;
+        out.token = args.substr(0, sp);
+        args.remove_prefix(sp + 1);
+
+        const std::size_t sp2 = args.find(' ');
+        out.codecs = sp2 == std::string_view::npos ? std::string_view() : trim(args.substr(sp2 + 1));
+        return parseNumber(args.substr(0, sp2), out.records);
+    }
+};
+
+/** "zbatch <codec> <payload>" — spooled readings, compressed.        */
+struct ZBatch
+{
+    static constexpr std::string_view keyword = "zbatch";
+    std::string_view codec;
+    std::string_view payload;
+
+    static bool parse(std::string_view args, ZBatch &out)
+    {
+        args = trim(args);
+        const std::size_t sp = args.find(' ');
+        if (sp == std::string_view::npos)
+            return false;
+        out.codec   = args.substr(0, sp);
+        out.payload = trim(args.substr(sp + 1));
+        return true;
+    }
+};
+
+/** "sync <ms>" — the server's clock when it sent this; echoed back in
+ *  "synced" so the server can time the round trip.                   */
+struct Sync
+{
+    static constexpr std::string_view keyword = "sync";
+    int64_t serverMs = 0;
+
+    static bool parse(std::string_view args, Sync &out)
+    { return parseNumber(args, out.serverMs); }
+};
+
+/** "synced <server ms> <client ms>" — the answer to "sync": its stamp,
+ *  and the client's monotonic clock when it answered. From here on the
+ *  client's stamps are on that clock.                                */
+struct Synced
+{
+    static constexpr std::string_view keyword = "synced";
+    int64_t serverMs = 0;
+    int64_t clientMs = 0;
+
+    static bool parse(std::string_view args, Synced &out)
+    {
+        args = trim(args);
+        const std::size_t sp = args.find(' ');
+        return sp != std::string_view::npos
+            && parseNumber(args.substr(0, sp), out.serverMs)
+            && parseNumber(args.substr(sp + 1), out.clientMs);
+    }
+};
+
+/** A bare number, "<C> [@<ms>]": a reading, in answer to "get temp" or
+ *  pushed.                                                            */
+struct Reading
+{
+    Milli   value;
+    int64_t stampMs = 0;
+    bool    stamped = false;
+};
+
+template <typename... T> struct CommandList {};
+
+using Commands = CommandList<SetThreshold, GetTemp, Batch, Frame, Channels, Mode,
+                             Resume, Session, ZBatch, Sync, Synced, SetConfig>;
+
+// ── Compile-time perfect hash over the keywords ──────────────────────────────
+
+namespace detail
+{
+
+constexpr uint32_t hash(std::string_view s, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;          // FNV-1a, seeded
+    for (char c : s)
+    {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename... C>
+constexpr std::array<std::string_view, sizeof...(C)> keywords(CommandList<C...>)
+{
+    return { C::keyword... };
+}
+
+constexpr auto        kKeywords = keywords(Commands {});
+constexpr std::size_t kSlots    = 64;         // power of two, roomy enough for a quick seed search
+constexpr uint8_t     kEmpty    = 0xFF;
+
+static_assert(kKeywords.size() * 2 <= kSlots, "grow kSlots");
+
+// Smallest seed under which no two keywords share a slot.
+constexpr uint32_t findSeed()
+{
+    for (uint32_t seed = 0; seed < 1u << 16; ++seed)
+    {
+        bool used[kSlots] = {};
+        bool ok = true;
+        for (std::string_view k : kKeywords)
+        {
+            const uint32_t slot = hash(k, seed) % kSlots;
+            if (used[slot]) { ok = false; break; }
+            used[slot] = true;
+        }
+        if (ok)
+            return seed;
+    }
+    return UINT32_MAX;
+}
+
+constexpr uint32_t kSeed = findSeed();
+static_assert(kSeed != UINT32_MAX, "no perfect hash seed for the keywords");
+
+constexpr std::array<uint8_t, kSlots> buildSlots()
+{
+    std::array<uint8_t, kSlots> slots {};
+    for (auto &s : slots)
+        s = kEmpty;
+    for (std::size_t i = 0; i < kKeywords.size(); ++i)
+        slots[hash(kKeywords[i], kSeed) % kSlots] = static_cast<uint8_t>(i);
+    return slots;
+}
+
+constexpr auto kSlotTable = buildSlots();
+
+/** Index of `word` in Commands, or -1.                               */
+constexpr int lookup(std::string_view word)
+{
+    const uint8_t i = kSlotTable[hash(word, kSeed) % kSlots];
+    return (i != kEmpty && kKeywords[i] == word) ? i : -1;
+}
+
+static_assert(lookup("set threshold") == 0 && lookup("get temp") == 1
+              && lookup("set") == -1, "keyword table");
+
+} // namespace detail
+
+// ── Dispatch ─────────────────────────────────────────────────────────────────
+
+enum class Result
+{
+    Handled,
+    Unhandled,      // known command, but this side has no handler for it
+    BadArgs,        // known command, arguments did not parse
+    Unknown         // neither a command nor a reading
+};
+
+namespace detail
+{
+
+template <typename Cmd, typename H>
+Result invoke(std::string_view args, H &handler)
+{
+    if constexpr (std::is_invocable_v<H &, const Cmd &>)
+    {
+        Cmd cmd {};
+        if (!Cmd::parse(args, cmd))
+            return Result::BadArgs;
+        handler(cmd);
+        return Result::Handled;
+    }
+    else
+    {
+        (void)args;
+        (void)handler;
+        return Result::Unhandled;
+    }
+}
+
+template <typename H>
+using Invoker = Result (*)(std::string_view, H &);
+
+template <typename H, typename... C>
+constexpr std::array<Invoker<H>, sizeof...(C)> invokers(CommandList<C...>)
+{
+    return { &invoke<C, H>... };
+}
+
+} // namespace detail
+
+/** Builds a handler out of lambdas, one per command type:
+ *    proto::Handlers h { [&](const proto::Frame &f) { … }, … };      */
+template <typename... F>
+struct Handlers : F...
+{
+    using F::operator()...;
+};
+template <typename... F> Handlers(F...) -> Handlers<F...>;
+
+/** Parses one line (no trailing newline) and calls handler(command).
+ *  Keywords are one or two words, so at most two hash probes are made:
+ *  "verb noun", then "verb". A line that is neither is tried as a
+ *  Reading.                                                          */
+template <typename H>
+Result dispatch(std::string_view line, H &handler)
+{
+    static constexpr auto table = detail::invokers<H>(Commands {});
+
+    line = trim(line);
+    const std::size_t sp1 = line.find(' ');
+    if (sp1 != std::string_view::npos)
+    {
+        const std::size_t sp2 = line.find(' ', sp1 + 1);
+        const int i = detail::lookup(line.substr(0, sp2));
+        if (i >= 0)
+            return table[i](sp2 == std::string_view::npos
+                                ? std::string_view() : line.substr(sp2 + 1),
+                            handler);
+    }
+
+    const int i = detail::lookup(line.substr(0, sp1));
+    if (i >= 0)
+        return table[i](sp1 == std::string_view::npos
+                            ? std::string_view() : line.substr(sp1 + 1),
+                        handler);
+
+    Reading r;
+    r.stamped = splitStamp(line, r.stampMs);
+    if (!parseNumber(line, r.value))
+        return Result::Unknown;
+    if constexpr (std::is_invocable_v<H &, const Reading &>)
+    {
+        handler(r);
+        return Result::Handled;
+    }
+    else
+    {
+        return Result::Unhandled;
+    }
+}
+
+} // namespace proto
+
+#endif // IOTPROTO_PROTOCOL_H
@@ -0,0 +1,39 @@
+#ifndef IOTPROTO_REACTOR_H
+#define IOTPROTO_REACTOR_H
+
+#include <sys/epoll.h>
+#include <cstdint>
+#include <functional>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Reactor — what libiotproto needs from the application's event loop.
+//
+//  The library never owns a loop: the client runs an epoll loop, the GUI
+//  runs Qt's. Either side implements these four calls on top of its own
+//  loop and AsyncChannel schedules its coroutines through them. Events
+//  use the epoll bits (EPOLLIN, EPOLLOUT, EPOLLHUP, EPOLLERR).
+// ─────────────────────────────────────────────────────────────────────────────
+class Reactor
+{
+public:
+    using IoCallback = std::function<void(uint32_t events)>;
+    using TimerId    = uint64_t;                 // 0 is never a valid id
+
+    virtual ~Reactor() = default;
+
+    /** Calls `cb` while `fd` is ready for any of `events`. Watching an
+     *  fd that is already watched replaces its events and callback.
+     *  Returns false if the loop refused the fd.                       */
+    virtual bool watch(int fd, uint32_t events, IoCallback cb) = 0;
+
+    /** Stops watching `fd`. Safe from inside that fd's own callback.   */
+    virtual void unwatch(int fd) = 0;
+
+    /** Calls `cb` once, `ms` milliseconds from now.                    */
+    virtual TimerId callAfter(long ms, std::function<void()> cb) = 0;
+
+    /** Cancels a timer that has not fired yet; unknown ids are ignored. */
+    virtual void cancelTimer(TimerId id) = 0;
+};
+
+#endif // IOTPROTO_REACTOR_H
@@ -0,0 +1,442 @@
+#ifndef IOTPROTO_SHMSOCKET_H
+#define IOTPROTO_SHMSOCKET_H
+
+#include "iotproto/UnixSocket.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <string>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  ShmSocket — the line protocol over two shared-memory rings.
+//
+//  A co-located agent connects to a Unix stream socket (the control
+//  socket) and receives, via SCM_RIGHTS, a memfd holding one single-
+//  producer/single-consumer byte ring per direction plus one eventfd per
+//  direction as the doorbell. After that no byte goes through the kernel:
+//  send() copies into the peer's ring and rings its doorbell, read()
+//  copies out of ours.
+//
+//  fd() is an epoll instance watching our doorbell and the control
+//  socket, so it polls readable for new data and for the peer going away
+//  (the control socket hangs up when the other process exits, crash or
+//  not). A writer that finds the ring full keeps the rest queued and sets
+//  wantSpace; the reader rings back once it has made room, and the next
+//  read() — which that ring-back wakes — moves the rest into the ring.
+// ─────────────────────────────────────────────────────────────────────────────
+
+inline constexpr const char *kLocalShmPath = "@iot-collector.shm";
+
+class ShmRing
+{
+public:
+    static constexpr uint32_t kCapacity = 64 * 1024;      // power of two
+
+    struct Header
+    {
+        alignas(64) std::atomic<uint32_t> head;           // producer
+        alignas(64) std::atomic<uint32_t> tail;           // consumer
+        alignas(64) std::atomic<uint32_t> closed;         // producer is gone
+        std::atomic<uint32_t>             wantSpace;      // producer is waiting
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "ring indices are shared between processes");
+
+    static constexpr std::size_t kBytes = sizeof(Header) + kCapacity;
+
+    ShmRing() = default;
+    explicit ShmRing(void *base)
+        : m_hdr(static_cast<Header *>(base)),
+          m_data(static_cast<char *>(base) + sizeof(Header)) {}
+
+    /** Only called by the side that created the mapping.               */
+    static void init(void *base) { new (base) Header{}; }
+
+    Header *header() const { return m_hdr; }
+
+    /** Copies as much of `data` as fits; returns the byte count.       */
+    std::size_t write(const char *data, std::size_t len)
+    {
+        const uint32_t head = m_hdr->head.load(std::memory_order_relaxed);
+        const uint32_t tail = m_hdr->tail.load(std::memory_order_acquire);
+        const std::size_t n = std::min<std::size_t>(len, kCapacity - (head - tail));
+        copyIn(head, data, n);
+        m_hdr->head.store(head + static_cast<uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    std::size_t read(char *buf, std::size_t len)
+    {
+        const uint32_t tail = m_hdr->tail.load(std::memory_order_relaxed);
+        const uint32_t head = m_hdr->head.load(std::memory_order_acquire);
+        const std::size_t n = std::min<std::size_t>(len, head - tail);
+        copyOut(tail, buf, n);
+        m_hdr->tail.store(tail + static_cast<uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    bool empty() const
+    {
+        return m_hdr->head.load(std::memory_order_acquire)
+            == m_hdr->tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    void copyIn(uint32_t pos, const char *src, std::size_t n)
+    {
+        const std::size_t off   = pos & (kCapacity - 1);
+        const std::size_t first = std::min(n, kCapacity - off);
+        std::memcpy(m_data + off, src, first);
+        std::memcpy(m_data, src + first, n - first);
+    }
+
+    void copyOut(uint32_t pos, char *dst, std::size_t n) const
+    {
+        const std::size_t off   = pos & (kCapacity - 1);
+        const std::size_t first = std::min(n, kCapacity - off);
+        std::memcpy(dst, m_data + off, first);
+        std::memcpy(dst + first, m_data, n - first);
+    }
+
+    Header *m_hdr  = nullptr;
+    char   *m_data = nullptr;
+};
+
+class ShmSocket : public StreamSocket
+{
+private:
+    // Layout of the memfd: [server -> client ring][client -> server ring]
+    static constexpr std::size_t kMapBytes = 2 * ShmRing::kBytes;
+
+    std::string m_path;
+    int         m_listenFd = -1;
+    int         m_ctrlFd   = -1;
+    int         m_rxBell   = -1;     // rung by the peer when our ring has data
+    int         m_txBell   = -1;     // rung by us for the peer
+    int         m_pollFd   = -1;
+    void       *m_map      = nullptr;
+    ShmRing     m_rx;
+    ShmRing     m_tx;
+    std::string m_txBuf;
+
+public:
+    explicit ShmSocket(std::string path = kLocalShmPath)
+        : m_path(std::move(path)) {}
+
+    ~ShmSocket() override { shutdown(); }
+
+    const std::string &path() const { return m_path; }
+
+    // ── Server side ──────────────────────────────────────────────────────────
+    int waitForConnect() override
+    {
+        m_listenFd = bindUnix(m_path, SOCK_STREAM);
+        if (m_listenFd < 0 || ::listen(m_listenFd, 5) < 0)
+        {
+            std::cerr << "[ShmSocket] cannot listen on " << m_path << "\n";
+            if (m_listenFd >= 0)
+                ::close(m_listenFd);
+            m_listenFd = -1;
+            return -1;
+        }
+        return m_listenFd;
+    }
+
+    /** Accepts the agent, creates the rings and hands them over. Returns
+     *  fd() on success.                                                 */
+    int acceptConnection() override
+    {
+        m_ctrlFd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (m_ctrlFd < 0)
+            return -1;
+
+        int memFd = ::memfd_create("iot-shm", MFD_CLOEXEC);
+        int s2c   = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        int c2s   = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        bool ok = memFd >= 0 && s2c >= 0 && c2s >= 0
+               && ::ftruncate(memFd, static_cast<off_t>(kMapBytes)) == 0
+               && map(memFd, /*server=*/true);
+        if (ok)
+        {
+            ShmRing::init(m_map);
+            ShmRing::init(static_cast<char *>(m_map) + ShmRing::kBytes);
+            const int fds[3] = { memFd, s2c, c2s };
+            ok = sendFds(fds);
+        }
+        if (memFd >= 0)
+            ::close(memFd);                 // the mapping keeps it alive
+
+        m_txBell = s2c;
+        m_rxBell = c2s;
+        if (!ok || !makePollFd())
+        {
+            std::cerr << "[ShmSocket] handshake failed: " << std::strerror(errno) << "\n";
+            closeClient();
+            return -1;
+        }
+        return m_pollFd;
+    }
+
+    void closeClient() override
+    {
+        if (m_map)
+        {
+            m_tx.header()->closed.store(1, std::memory_order_release);
+            ring(m_txBell);
+            ::munmap(m_map, kMapBytes);
+            m_map = nullptr;
+        }
+        for (int *fd : { &m_pollFd, &m_rxBell, &m_txBell, &m_ctrlFd })
+        {
+            if (*fd >= 0)
+                ::close(*fd);
+            *fd = -1;
+        }
+        m_rx = ShmRing();
+        m_tx = ShmRing();
+        m_txBuf.clear();
+    }
+
+    int listenFd() const override { return m_listenFd; }
+
+    std::string peerAddress() const override { return "shm:" + m_path; }
+
+    // ── Client side ──────────────────────────────────────────────────────────
+    /** Connects to the control socket and maps the rings. Completes
+     *  synchronously (a local round trip), then rings our own doorbell
+     *  once so a caller waiting on fd() for the connect sees it.        */
+    int connect() override
+    {
+        sockaddr_un addr;
+        socklen_t   len = 0;
+        if (!unixAddress(m_path, addr, len))
+            return -1;
+
+        m_ctrlFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_ctrlFd < 0)
+            return -1;
+
+        timeval tv{2, 0};
+        ::setsockopt(m_ctrlFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        int fds[3] = { -1, -1, -1 };
+        bool ok = ::connect(m_ctrlFd, reinterpret_cast<sockaddr *>(&addr), len) == 0
+               && recvFds(fds)
+               && map(fds[0], /*server=*/false);
+        if (fds[0] >= 0)
+            ::close(fds[0]);
+        m_rxBell = fds[1];
+        m_txBell = fds[2];
+        if (!ok || !makePollFd())
+        {
+            closeClient();
+            return -1;
+        }
+        ring(m_rxBell);
+        return 0;
+    }
+
+    /** Non-blocking-connect interface of the client loops; connect()
+     *  has already finished by the time anyone asks.                   */
+    int finishConnect() { return m_map ? 0 : ENOTCONN; }
+
+    // ── Data path ────────────────────────────────────────────────────────────
+    void send(const std::string &message) override
+    {
+        write(message.data(), message.size());
+    }
+
+    ssize_t write(const char *data, std::size_t len) override
+    {
+        if (!m_map)
+        {
+            errno = ENOTCONN;
+            return -1;
+        }
+        m_txBuf.append(data, len);
+        if (!flush())
+        {
+            errno = EPIPE;
+            return -1;
+        }
+        return static_cast<ssize_t>(len);
+    }
+
+    /** Moves queued bytes into the peer's ring. Returns false once the
+     *  peer has closed its end.                                         */
+    bool flush()
+    {
+        if (!m_map || m_rx.header()->closed.load(std::memory_order_acquire))
+        {
+            m_txBuf.clear();
+            return false;
+        }
+        if (m_txBuf.empty())
+            return true;
+
+        std::size_t n = m_tx.write(m_txBuf.data(), m_txBuf.size());
+        m_txBuf.erase(0, n);
+        if (!m_txBuf.empty())
+        {
+            // Ask for a ring-back, then retry once in case the reader
+            // drained everything before it could see the flag.
+            m_tx.header()->wantSpace.store(1, std::memory_order_seq_cst);
+            std::size_t more = m_tx.write(m_txBuf.data(), m_txBuf.size());
+            m_txBuf.erase(0, more);
+            n += more;
+        }
+        if (n > 0)
+            ring(m_txBell);
+        return true;
+    }
+
+    std::size_t pendingBytes() const { return m_txBuf.size(); }
+
+    ssize_t read(char *buf, std::size_t len) override
+    {
+        if (!m_map)
+            return 0;
+
+        eventfd_t count;
+        ::eventfd_read(m_rxBell, &count);   // EAGAIN just means no new ring
+
+        // The doorbell also carries the peer's ring-back once it has made
+        // room, so this is where bytes left over from write() move on.
+        if (!m_txBuf.empty())
+            flush();
+
+        std::size_t n = m_rx.read(buf, len);
+        if (n > 0)
+        {
+            if (m_rx.header()->wantSpace.exchange(0, std::memory_order_seq_cst))
+                ring(m_txBell);
+            // The doorbell is drained; keep fd() readable while bytes remain.
+            if (!m_rx.empty())
+                ring(m_rxBell);
+            return static_cast<ssize_t>(n);
+        }
+
+        if (m_rx.header()->closed.load(std::memory_order_acquire))
+            return 0;
+        char probe;
+        if (::recv(m_ctrlFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT) == 0)
+            return 0;                       // peer process is gone
+
+        // The writer may be parked on a full ring from before we drained it.
+        if (m_rx.header()->wantSpace.exchange(0, std::memory_order_seq_cst))
+            ring(m_txBell);
+        errno = EAGAIN;
+        return -1;
+    }
+
+    void receive() override
+    {
+        char buf[1024];
+        ssize_t n = read(buf, sizeof(buf) - 1);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            std::cout << "[Shm] Received: " << buf << "\n";
+        }
+    }
+
+    void shutdown() override
+    {
+        closeClient();
+        if (m_listenFd >= 0)
+        {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            if (m_path[0] != '@')
+                ::unlink(m_path.c_str());
+        }
+    }
+
+    int fd() const override { return m_pollFd; }
+
+private:
+    static void ring(int bell)
+    {
+        if (bell >= 0)
+            ::eventfd_write(bell, 1);
+    }
+
+    bool map(int memFd, bool server)
+    {
+        void *p = ::mmap(nullptr, kMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+        if (p == MAP_FAILED)
+            return false;
+        m_map = p;
+        char *s2c = static_cast<char *>(p);
+        char *c2s = s2c + ShmRing::kBytes;
+        m_tx = ShmRing(server ? s2c : c2s);
+        m_rx = ShmRing(server ? c2s : s2c);
+        return true;
+    }
+
+    bool makePollFd()
+    {
+        if (m_rxBell < 0 || m_txBell < 0)
+            return false;
+        m_pollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (m_pollFd < 0)
+            return false;
+        epoll_event bell{};
+        bell.events  = EPOLLIN;
+        bell.data.fd = m_rxBell;
+        epoll_event ctrl{};
+        ctrl.events  = EPOLLIN | EPOLLRDHUP;
+        ctrl.data.fd = m_ctrlFd;
+        return ::epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_rxBell, &bell) == 0
+            && ::epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_ctrlFd, &ctrl) == 0;
+    }
+
+    bool sendFds(const int (&fds)[3])
+    {
+        char     tag = 'R';
+        iovec    iov{ &tag, 1 };
+        alignas(cmsghdr) char ctl[CMSG_SPACE(sizeof(fds))] = {};
+        msghdr   msg{};
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = ctl;
+        msg.msg_controllen = sizeof(ctl);
+        cmsghdr *c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type  = SCM_RIGHTS;
+        c->cmsg_len   = CMSG_LEN(sizeof(fds));
+        std::memcpy(CMSG_DATA(c), fds, sizeof(fds));
+        return ::sendmsg(m_ctrlFd, &msg, MSG_NOSIGNAL) == 1;
+    }
+
+    bool recvFds(int (&fds)[3])
+    {
+        char     tag = 0;
+        iovec    iov{ &tag, 1 };
+        alignas(cmsghdr) char ctl[CMSG_SPACE(sizeof(fds))] = {};
+        msghdr   msg{};
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = ctl;
+        msg.msg_controllen = sizeof(ctl);
+        if (::recvmsg(m_ctrlFd, &msg, MSG_CMSG_CLOEXEC) != 1)
+            return false;
+        cmsghdr *c = CMSG_FIRSTHDR(&msg);
+        if (!c || c->cmsg_type != SCM_RIGHTS || c->cmsg_len != CMSG_LEN(sizeof(fds)))
+            return false;
+        std::memcpy(fds, CMSG_DATA(c), sizeof(fds));
+        return true;
+    }
+};
+
+#endif // IOTPROTO_SHMSOCKET_H
@@ -0,0 +1,428 @@
+#ifndef IOTPROTO_SOCKET_H
+#define IOTPROTO_SOCKET_H
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Transmit modes for stream sockets.
+//
+//  LowLatency sets TCP_NODELAY: a poll or a single reading goes out the
+//  moment send() is called instead of waiting up to one RTT for Nagle to
+//  coalesce it with the next write (and stalling behind a delayed ACK).
+//  Bulk leaves Nagle on, and callers that know they are about to write a
+//  burst of frames — a backlog replay, a broadcast — wrap it in a TcpCork
+//  so the kernel packs the frames into full segments and flushes once.
+// ─────────────────────────────────────────────────────────────────────────────
+enum class TxMode { LowLatency, Bulk };
+
+/** Applies `mode` to a connected TCP socket. Returns false on error.  */
+inline bool setTxMode(int fd, TxMode mode)
+{
+    if (fd < 0)
+        return false;
+    int on = (mode == TxMode::LowLatency) ? 1 : 0;
+    return ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) == 0;
+}
+
+/** Holds TCP_CORK for its lifetime: every frame written in between is
+ *  queued and sent as full segments when the cork is pulled, regardless
+ *  of the socket's TCP_NODELAY setting.                                 */
+class TcpCork
+{
+public:
+    explicit TcpCork(int fd) : m_fd(fd) { set(1); }
+    ~TcpCork() { set(0); }
+
+    TcpCork(const TcpCork &)            = delete;
+    TcpCork &operator=(const TcpCork &) = delete;
+
+private:
+    void set(int on)
+    {
+        if (m_fd >= 0)
+            ::setsockopt(m_fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+    }
+
+    int m_fd;
+};
+
+class Socket
+{
+public:
+    virtual ~Socket() = default;
+
+    /** Server side: bind + listen (TCP) or just bind (UDP).
+     *  Returns the listening/bound file descriptor, or -1 on error.    */
+    virtual int  waitForConnect()                   = 0;
+
+    /** Client side: connect to server.
+     *  Returns 0 on success, -1 on failure.                            */
+    virtual int  connect()                          = 0;
+
+    /** Send a message over the socket.                                  */
+    virtual void send(const std::string &message)   = 0;
+
+    /** Receive data; prints to stdout (used by client terminal).        */
+    virtual void receive()                          = 0;
+
+    /** Close the socket.                                                */
+    virtual void shutdown()                         = 0;
+
+    /** Expose the raw file descriptor so callers can use QSocketNotifier
+     *  or epoll without subclassing.                                    */
+    virtual int  fd() const = 0;
+
+    /** Non-blocking byte I/O, same return convention as recv()/send():
+     *  bytes moved, 0 once the peer has gone, -1 with errno set (EAGAIN:
+     *  wait for fd() to poll ready and try again).                      */
+    virtual ssize_t read(char *buf, std::size_t len)
+    {
+        return ::recv(fd(), buf, len, MSG_DONTWAIT);
+    }
+    virtual ssize_t write(const char *data, std::size_t len)
+    {
+        return ::send(fd(), data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+};
+
+/** Connection-oriented server transport: listen, accept one client, then
+ *  exchange a byte stream with it through read()/write().              */
+class StreamSocket : public Socket
+{
+public:
+    /** Accepts the pending client. Returns the fd to poll for its data,
+     *  or -1 on error.                                                  */
+    virtual int  acceptConnection()                 = 0;
+
+    /** Drops the accepted client but keeps listening.                   */
+    virtual void closeClient()                      = 0;
+
+    virtual int  listenFd() const                   = 0;
+
+    /** Name of the accepted client, used as its device id.             */
+    virtual std::string peerAddress() const         = 0;
+
+    /** See TxMode. Transports without Nagle have nothing to switch.    */
+    virtual bool setTxMode(TxMode) { return true; }
+};
+
+/** Connectionless server transport: every datagram carries its sender,
+ *  and sendReply() answers whoever sent the last one.                  */
+class DatagramSocket : public Socket
+{
+public:
+    /** Never blocks; an empty string means the queue is drained.      */
+    virtual std::string receiveFrom()                        = 0;
+    virtual void        sendReply(const std::string &message) = 0;
+    virtual std::string peerAddress() const                  = 0;
+
+    /** One datagram per call, truncated to `len`; never returns 0.     */
+    ssize_t read(char *buf, std::size_t len) override
+    {
+        std::string msg = receiveFrom();
+        if (msg.empty())
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        const std::size_t n = std::min(len, msg.size());
+        std::memcpy(buf, msg.data(), n);
+        return static_cast<ssize_t>(n);
+    }
+    ssize_t write(const char *data, std::size_t len) override
+    {
+        sendReply(std::string(data, len));
+        return static_cast<ssize_t>(len);
+    }
+};
+
+class TCPSocket : public StreamSocket
+{
+private:
+    int                m_listenFd   = -1;
+    int                m_sockfd     = -1;
+    struct sockaddr_in m_serverAddr{};
+    struct sockaddr_in m_clientAddr{};
+    socklen_t          m_addrLen    = sizeof(m_clientAddr);
+
+    std::string        m_targetIp   = "127.0.0.1";
+    uint16_t           m_targetPort = 8080;
+
+public:
+    TCPSocket()
+    {
+        std::memset(&m_serverAddr, 0, sizeof(m_serverAddr));
+        std::memset(&m_clientAddr, 0, sizeof(m_clientAddr));
+    }
+
+    ~TCPSocket() override { shutdown(); }
+
+    /** Set the remote address before calling connect() on the client side. */
+    void setTarget(const std::string &ip, uint16_t port)
+    {
+        m_targetIp   = ip;
+        m_targetPort = port;
+    }
+
+    int waitForConnect() override
+    {
+        m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenFd < 0)
+        {
+            std::cerr << "[TCPSocket] socket() failed\n";
+            return -1;
+        }
+
+        int opt = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        m_serverAddr.sin_family      = AF_INET;
+        m_serverAddr.sin_addr.s_addr = INADDR_ANY;
+        m_serverAddr.sin_port        = htons(8080);
+
+        if (::bind(m_listenFd,
+                   reinterpret_cast<sockaddr *>(&m_serverAddr),
+                   sizeof(m_serverAddr)) < 0)
+        {
+            std::cerr << "[TCPSocket] bind() failed\n";
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            return -1;
+        }
+
+        if (::listen(m_listenFd, 5) < 0)
+        {
+            std::cerr << "[TCPSocket] listen() failed\n";
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            return -1;
+        }
+
+        return m_listenFd;
+    }
+
+    int acceptConnection() override
+    {
+        m_sockfd = ::accept(m_listenFd,
+                            reinterpret_cast<sockaddr *>(&m_clientAddr),
+                            &m_addrLen);
+        return m_sockfd;
+    }
+
+    int fd() const override { return m_sockfd; }
+
+    int listenFd() const override { return m_listenFd; }
+
+    void closeClient() override
+    {
+        if (m_sockfd >= 0)
+        {
+            ::close(m_sockfd);
+            m_sockfd = -1;
+        }
+    }
+
+    /** See TxMode. Applies to the connected/accepted socket.            */
+    bool setTxMode(TxMode mode) override { return ::setTxMode(fd(), mode); }
+
+    /** Dotted-quad address of the last accepted client.                */
+    std::string peerAddress() const override
+    {
+        char buf[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &m_clientAddr.sin_addr, buf, sizeof(buf));
+        return buf;
+    }
+
+    int connect() override
+    {
+        m_sockfd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[TCPSocket] socket() failed\n";
+            return -1;
+        }
+
+        m_serverAddr.sin_family = AF_INET;
+        m_serverAddr.sin_port   = htons(m_targetPort);
+        inet_pton(AF_INET, m_targetIp.c_str(), &m_serverAddr.sin_addr);
+
+        if (::connect(m_sockfd,
+                      reinterpret_cast<sockaddr *>(&m_serverAddr),
+                      sizeof(m_serverAddr)) < 0)
+        {
+            std::cerr << "[TCPSocket] connect() failed\n";
+            ::close(m_sockfd);
+            m_sockfd = -1;
+            return -1;
+        }
+        return 0;
+    }
+
+    void send(const std::string &message) override
+    {
+        if (m_sockfd < 0)
+            return;
+        ::send(m_sockfd, message.c_str(), message.size(), MSG_NOSIGNAL);
+    }
+
+    void receive() override
+    {
+        if (m_sockfd < 0)
+            return;
+        char buf[1024];
+        int n = ::recv(m_sockfd, buf, sizeof(buf) - 1, 0);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            std::cout << "[TCP] Received: " << buf << "\n";
+        }
+    }
+
+    void shutdown() override
+    {
+        if (m_sockfd >= 0)
+        {
+            ::close(m_sockfd);
+            m_sockfd = -1;
+        }
+        if (m_listenFd >= 0)
+        {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+        }
+    }
+};
+
+class UDPSocket : public DatagramSocket
+{
+private:
+    int                m_sockfd     = -1;
+    struct sockaddr_in m_remoteAddr{};
+    socklen_t          m_addrLen    = sizeof(m_remoteAddr);
+
+    std::string        m_targetIp   = "127.0.0.1";
+    uint16_t           m_targetPort = 8081;
+
+public:
+    UDPSocket() { std::memset(&m_remoteAddr, 0, sizeof(m_remoteAddr)); }
+    ~UDPSocket() override { shutdown(); }
+
+    /** Set the remote address before calling connect() on the client side. */
+    void setTarget(const std::string &ip, uint16_t port)
+    {
+        m_targetIp   = ip;
+        m_targetPort = port;
+    }
+
+    int waitForConnect() override
+    {
+        m_sockfd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[UDPSocket] socket() failed\n";
+            return -1;
+        }
+
+        m_remoteAddr.sin_family      = AF_INET;
+        m_remoteAddr.sin_addr.s_addr = INADDR_ANY;
+        m_remoteAddr.sin_port        = htons(8081);
+
+        if (::bind(m_sockfd,
+                   reinterpret_cast<sockaddr *>(&m_remoteAddr),
+                   sizeof(m_remoteAddr)) < 0)
+        {
+            std::cerr << "[UDPSocket] bind() failed\n";
+            ::close(m_sockfd);
+            m_sockfd = -1;
+            return -1;
+        }
+        std::cout << "[UDPSocket] Bound on port 8081\n";
+        return m_sockfd;
+    }
+
+    int connect() override
+    {
+        m_sockfd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[UDPSocket] socket() failed\n";
+            return -1;
+        }
+        m_remoteAddr.sin_family = AF_INET;
+        m_remoteAddr.sin_port   = htons(m_targetPort);
+        inet_pton(AF_INET, m_targetIp.c_str(), &m_remoteAddr.sin_addr);
+        return 0;
+    }
+
+    void send(const std::string &message) override
+    {
+        if (m_sockfd < 0)
+            return;
+        ::sendto(m_sockfd, message.c_str(), message.size(), 0,
+                 reinterpret_cast<sockaddr *>(&m_remoteAddr), sizeof(m_remoteAddr));
+    }
+
+    void receive() override
+    {
+        if (m_sockfd < 0)
+            return;
+        const std::string msg = receiveFrom();
+        if (!msg.empty())
+            std::cout << "[UDP] Received: " << msg << "\n";
+    }
+
+    /** Receive a datagram and return its content as std::string.
+     *  Also captures the sender address so we can reply. Never blocks:
+     *  an empty string means nothing is queued.                       */
+    std::string receiveFrom() override
+    {
+        if (m_sockfd < 0)
+            return {};
+        char        buf[1024];
+        sockaddr_in from{};
+        m_addrLen = sizeof(from);          // in/out: reset on every call
+        ssize_t n = ::recvfrom(m_sockfd, buf, sizeof(buf) - 1, MSG_DONTWAIT,
+                               reinterpret_cast<sockaddr *>(&from), &m_addrLen);
+        if (n <= 0)
+            return {};
+        m_remoteAddr = from;
+        return std::string(buf, static_cast<std::size_t>(n));
+    }
+
+    /** Dotted-quad address of the last datagram's sender.              */
+    std::string peerAddress() const override
+    {
+        char buf[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &m_remoteAddr.sin_addr, buf, sizeof(buf));
+        return buf;
+    }
+
+    void sendReply(const std::string &message) override
+    {
+        ::sendto(m_sockfd, message.c_str(), message.size(), 0,
+                 reinterpret_cast<sockaddr *>(&m_remoteAddr), sizeof(m_remoteAddr));
+    }
+
+    void shutdown() override
+    {
+        if (m_sockfd >= 0)
+        {
+            ::close(m_sockfd);
+            m_sockfd = -1;
+        }
+    }
+
+    int fd() const override { return m_sockfd; }
+};
+
+#endif // IOTPROTO_SOCKET_H
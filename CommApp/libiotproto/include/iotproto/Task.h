@@ -0,0 +1,152 @@
+#ifndef IOTPROTO_TASK_H
+#define IOTPROTO_TASK_H
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Task<T> — the coroutine type of the async API (C++20 only).
+//
+//  A Task is lazy: calling the coroutine only creates its frame, and it
+//  starts running when it is co_awaited. When it finishes it resumes its
+//  awaiter directly (symmetric transfer), so a chain of nested awaits
+//  costs no stack and no event-loop round trip. spawn() starts a
+//  Task<void> that nobody awaits — one per device session — and frees it
+//  when it returns. Exceptions are not used by this codebase; one that
+//  escapes a task terminates the process.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+template <typename T = void> class Task;
+
+namespace task_detail
+{
+
+struct PromiseBase
+{
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            return h.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase
+{
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    void return_value(T v) { value.emplace(std::move(v)); }
+    T    result()          { return std::move(*value); }
+};
+
+template <>
+struct Promise<void> : PromiseBase
+{
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void result() noexcept {}
+};
+
+} // namespace task_detail
+
+template <typename T>
+class Task
+{
+public:
+    using promise_type = task_detail::Promise<T>;
+    using Handle       = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle h) noexcept : m_h(h) {}
+    Task(Task &&other) noexcept : m_h(std::exchange(other.m_h, {})) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_h)
+                m_h.destroy();
+            m_h = std::exchange(other.m_h, {});
+        }
+        return *this;
+    }
+    Task(const Task &)            = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task()
+    {
+        if (m_h)
+            m_h.destroy();
+    }
+
+    // ── Awaiting ─────────────────────────────────────────────────────────────
+    bool await_ready() const noexcept { return !m_h || m_h.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        m_h.promise().continuation = awaiter;
+        return m_h;
+    }
+
+    T await_resume() { return m_h.promise().result(); }
+
+private:
+    Handle m_h;
+};
+
+namespace task_detail
+{
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+/** Fire-and-forget frame that owns the spawned task until it is done. */
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+inline Detached run(Task<void> task) { co_await task; }
+
+} // namespace task_detail
+
+/** Runs `task` up to its first suspension now, and the rest from the
+ *  event loop. Everything it references must outlive it.             */
+inline void spawn(Task<void> task)
+{
+    task_detail::run(std::move(task));
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // IOTPROTO_TASK_H
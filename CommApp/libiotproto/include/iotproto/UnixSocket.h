@@ -0,0 +1,286 @@
+#ifndef IOTPROTO_UNIXSOCKET_H
+#define IOTPROTO_UNIXSOCKET_H
+
+#include "iotproto/Socket.h"
+
+#include <sys/un.h>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  AF_UNIX transports for a collector and sensor agents on the same host.
+//
+//  Same line protocol as TCP/UDP, minus the loopback IP stack: no
+//  checksums, no segmentation, no Nagle. A path starting with '@' names a
+//  Linux abstract socket — nothing is left on the filesystem and no
+//  directory has to be writable; any other path is an ordinary socket
+//  file, replaced if a stale one is in the way.
+// ─────────────────────────────────────────────────────────────────────────────
+
+inline constexpr const char *kLocalStreamPath = "@iot-collector";
+inline constexpr const char *kLocalDgramPath  = "@iot-collector.dgram";
+
+/** Fills `addr`/`len` for `path`. Returns false if it does not fit.   */
+inline bool unixAddress(const std::string &path, sockaddr_un &addr, socklen_t &len)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        return false;
+
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    if (path[0] == '@')
+    {
+        addr.sun_path[0] = '\0';
+        len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+    }
+    else
+    {
+        len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+    }
+    return true;
+}
+
+/** socket() + bind() on `path`, removing a stale socket file first.
+ *  Returns the bound fd, or -1.                                        */
+inline int bindUnix(const std::string &path, int type)
+{
+    sockaddr_un addr;
+    socklen_t   len = 0;
+    if (!unixAddress(path, addr, len))
+        return -1;
+
+    int fd = ::socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (path[0] != '@')
+        ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), len) < 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+class UnixStreamSocket : public StreamSocket
+{
+private:
+    std::string m_path;
+    int         m_listenFd = -1;
+    int         m_sockfd   = -1;
+
+public:
+    explicit UnixStreamSocket(std::string path = kLocalStreamPath)
+        : m_path(std::move(path)) {}
+
+    ~UnixStreamSocket() override { shutdown(); }
+
+    const std::string &path() const { return m_path; }
+
+    int waitForConnect() override
+    {
+        m_listenFd = bindUnix(m_path, SOCK_STREAM);
+        if (m_listenFd < 0)
+        {
+            std::cerr << "[UnixStreamSocket] bind() failed on " << m_path << "\n";
+            return -1;
+        }
+        if (::listen(m_listenFd, 5) < 0)
+        {
+            std::cerr << "[UnixStreamSocket] listen() failed\n";
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            return -1;
+        }
+        return m_listenFd;
+    }
+
+    int acceptConnection() override
+    {
+        m_sockfd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        return m_sockfd;
+    }
+
+    void closeClient() override
+    {
+        if (m_sockfd >= 0)
+        {
+            ::close(m_sockfd);
+            m_sockfd = -1;
+        }
+    }
+
+    int listenFd() const override { return m_listenFd; }
+    int fd() const override       { return m_sockfd; }
+
+    std::string peerAddress() const override { return "unix:" + m_path; }
+
+    int connect() override
+    {
+        sockaddr_un addr;
+        socklen_t   len = 0;
+        if (!unixAddress(m_path, addr, len))
+            return -1;
+
+        m_sockfd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[UnixStreamSocket] socket() failed\n";
+            return -1;
+        }
+        if (::connect(m_sockfd, reinterpret_cast<sockaddr *>(&addr), len) < 0)
+        {
+            std::cerr << "[UnixStreamSocket] connect() failed\n";
+            ::close(m_sockfd);
+            m_sockfd = -1;
+            return -1;
+        }
+        return 0;
+    }
+
+    void send(const std::string &message) override
+    {
+        if (m_sockfd < 0)
+            return;
+        ::send(m_sockfd, message.c_str(), message.size(), MSG_NOSIGNAL);
+    }
+
+    void receive() override
+    {
+        if (m_sockfd < 0)
+            return;
+        char buf[1024];
+        ssize_t n = ::recv(m_sockfd, buf, sizeof(buf) - 1, 0);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            std::cout << "[Unix] Received: " << buf << "\n";
+        }
+    }
+
+    void shutdown() override
+    {
+        closeClient();
+        if (m_listenFd >= 0)
+        {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+            if (m_path[0] != '@')
+                ::unlink(m_path.c_str());
+        }
+    }
+};
+
+/** AF_UNIX datagrams. The client autobinds an abstract address so the
+ *  server's sendReply() has somewhere to go. receiveFrom() never blocks
+ *  and returns an empty string once the queue is drained, on both sides. */
+class UnixDgramSocket : public DatagramSocket
+{
+private:
+    std::string m_path;
+    int         m_sockfd    = -1;
+    bool        m_bound     = false;     // server side: owns m_path
+    sockaddr_un m_remoteAddr{};
+    socklen_t   m_remoteLen = 0;
+
+public:
+    explicit UnixDgramSocket(std::string path = kLocalDgramPath)
+        : m_path(std::move(path)) {}
+
+    ~UnixDgramSocket() override { shutdown(); }
+
+    const std::string &path() const { return m_path; }
+
+    int waitForConnect() override
+    {
+        m_sockfd = bindUnix(m_path, SOCK_DGRAM);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[UnixDgramSocket] bind() failed on " << m_path << "\n";
+            return -1;
+        }
+        m_bound = true;
+        return m_sockfd;
+    }
+
+    int connect() override
+    {
+        if (!unixAddress(m_path, m_remoteAddr, m_remoteLen))
+            return -1;
+
+        m_sockfd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_sockfd < 0)
+        {
+            std::cerr << "[UnixDgramSocket] socket() failed\n";
+            return -1;
+        }
+
+        // Binding just the family asks the kernel for a unique abstract name.
+        sockaddr_un self{};
+        self.sun_family = AF_UNIX;
+        if (::bind(m_sockfd, reinterpret_cast<sockaddr *>(&self), sizeof(sa_family_t)) < 0)
+        {
+            std::cerr << "[UnixDgramSocket] autobind failed\n";
+            ::close(m_sockfd);
+            m_sockfd = -1;
+            return -1;
+        }
+        return 0;
+    }
+
+    void send(const std::string &message) override { sendReply(message); }
+
+    void receive() override
+    {
+        std::string msg = receiveFrom();
+        if (!msg.empty())
+            std::cout << "[Unix] Received: " << msg << "\n";
+    }
+
+    std::string receiveFrom() override
+    {
+        if (m_sockfd < 0)
+            return {};
+        char        buf[1024];
+        sockaddr_un from{};
+        socklen_t   fromLen = sizeof(from);
+        ssize_t n = ::recvfrom(m_sockfd, buf, sizeof(buf) - 1, MSG_DONTWAIT,
+                               reinterpret_cast<sockaddr *>(&from), &fromLen);
+        if (n <= 0)
+            return {};
+        // Abstract names are length-delimited, so keep the exact length.
+        m_remoteAddr = from;
+        m_remoteLen  = fromLen;
+        return std::string(buf, static_cast<std::size_t>(n));
+    }
+
+    void sendReply(const std::string &message) override
+    {
+        if (m_sockfd < 0 || m_remoteLen == 0)
+            return;
+        ::sendto(m_sockfd, message.c_str(), message.size(), MSG_DONTWAIT,
+                 reinterpret_cast<sockaddr *>(&m_remoteAddr), m_remoteLen);
+    }
+
+    std::string peerAddress() const override { return "unix-dgram:" + m_path; }
+
+    void shutdown() override
+    {
+        if (m_sockfd >= 0)
+        {
+            ::close(m_sockfd);
+            m_sockfd = -1;
+        }
+        if (m_bound && m_path[0] != '@')
+            ::unlink(m_path.c_str());
+        m_bound     = false;
+        m_remoteLen = 0;
+    }
+
+    int fd() const override { return m_sockfd; }
+};
+
+#endif // IOTPROTO_UNIXSOCKET_H
@@ -0,0 +1,548 @@
+#ifndef IOTPROTO_URINGSOCKET_H
+#define IOTPROTO_URINGSOCKET_H
+
+#include "iotproto/Socket.h"
+
+#if IOTPROTO_HAVE_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  UringTcpSocket — the TCP server transport on io_uring instead of
+//  readiness polling.
+//
+//  Three requests stay armed for the life of a connection:
+//    • one multishot accept on the listening socket,
+//    • one multishot recv on the client, reading into a pool of kernel-
+//      picked ("provided") buffers, so no per-read submission at all;
+//      consumed buffers are handed back in batches of half the pool,
+//    • and sends, submitted as one linked chain per batch of queued
+//      messages so they reach the wire in order with one io_uring_enter().
+//  Completions land in memory shared with the kernel; reaping them costs
+//  no syscall. The ring fd itself polls readable whenever completions are
+//  pending, which is what listenFd() and fd() return, so the caller keeps
+//  its QSocketNotifier / epoll loop unchanged.
+//
+//  Talks to the kernel directly (needs Linux 6.0 for multishot recv);
+//  available() says whether io_uring is usable here at all. Buffers are
+//  provided with IORING_OP_PROVIDE_BUFFERS rather than a registered
+//  buffer ring, which some kernels answer with ENOBUFS on every recv.
+// ─────────────────────────────────────────────────────────────────────────────
+class UringTcpSocket : public StreamSocket
+{
+public:
+    explicit UringTcpSocket(uint16_t port = 8080) : m_port(port) {}
+    ~UringTcpSocket() override { shutdown(); }
+
+    UringTcpSocket(const UringTcpSocket &)            = delete;
+    UringTcpSocket &operator=(const UringTcpSocket &) = delete;
+
+    /** False when the kernel lacks io_uring or it is disabled
+     *  (kernel.io_uring_disabled, seccomp).                             */
+    static bool available()
+    {
+        static const bool ok = [] {
+            io_uring_params p{};
+            int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &p));
+            if (fd < 0)
+                return false;
+            ::close(fd);
+            return true;
+        }();
+        return ok;
+    }
+
+    // ── Server side ──────────────────────────────────────────────────────────
+    int waitForConnect() override
+    {
+        m_listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0)
+        {
+            std::cerr << "[UringTcpSocket] socket() failed\n";
+            return -1;
+        }
+        int opt = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = INADDR_ANY;
+        addr.sin_port        = htons(m_port);
+        if (::bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+            || ::listen(m_listenFd, 64) < 0)
+        {
+            std::cerr << "[UringTcpSocket] bind()/listen() failed\n";
+            shutdown();
+            return -1;
+        }
+
+        if (!setupRing() || !setupBuffers())
+        {
+            std::cerr << "[UringTcpSocket] io_uring setup failed: " << std::strerror(errno)
+                      << " (multishot recv needs Linux 6.0)\n";
+            shutdown();
+            return -1;
+        }
+
+        armAccept();
+        submit();
+        return m_ringFd;
+    }
+
+    /** Takes the next connection the multishot accept delivered. Returns
+     *  fd() or -1 with errno == EAGAIN if the wakeup was for something
+     *  else.                                                            */
+    int acceptConnection() override
+    {
+        reap();
+        if (m_clientFd >= 0 || m_accepted.empty())
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        m_clientFd = m_accepted.front();
+        m_accepted.pop_front();
+        m_rxEof = false;
+
+        socklen_t len = sizeof(m_peer);
+        ::getpeername(m_clientFd, reinterpret_cast<sockaddr *>(&m_peer), &len);
+
+        armRecv();
+        submit();
+        return m_ringFd;
+    }
+
+    void closeClient() override
+    {
+        if (m_clientFd < 0)
+            return;
+
+        // shutdown() ends the multishot recv and fails queued sends; their
+        // completions arrive tagged with the old generation and are
+        // dropped, but the kernel may still read in-flight send buffers
+        // until then, so those are parked rather than freed.
+        ::shutdown(m_clientFd, SHUT_RDWR);
+        ::close(m_clientFd);
+        m_clientFd = -1;
+        ++m_gen;
+
+        // Moving the deque keeps its elements (and short strings' inline
+        // bytes) where the kernel was told they are.
+        if (m_txAcked < m_txFlight.size())
+        {
+            m_orphanCqes += m_txFlight.size() - m_txAcked;
+            m_txOrphans.push_back(std::move(m_txFlight));
+        }
+        m_txFlight.clear();
+        m_txQueue.clear();
+        m_txAcked  = 0;
+        m_txBroken = false;
+        m_txError  = false;
+        m_rxBuf.clear();
+        m_rxEof    = false;
+
+        // Someone else may already be waiting in the accept queue.
+        if (!m_accepted.empty())
+            kick();
+    }
+
+    int listenFd() const override { return m_listenFd >= 0 ? m_ringFd : -1; }
+    int fd() const override       { return m_clientFd >= 0 ? m_ringFd : -1; }
+
+    std::string peerAddress() const override
+    {
+        char buf[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &m_peer.sin_addr, buf, sizeof(buf));
+        return buf;
+    }
+
+    bool setTxMode(TxMode mode) override { return ::setTxMode(m_clientFd, mode); }
+
+    int connect() override
+    {
+        std::cerr << "[UringTcpSocket] server side only\n";
+        return -1;
+    }
+
+    // ── Data path ────────────────────────────────────────────────────────────
+    ssize_t read(char *buf, std::size_t len) override
+    {
+        reap();
+        if (!m_rxBuf.empty())
+        {
+            const std::size_t n = std::min(len, m_rxBuf.size());
+            std::memcpy(buf, m_rxBuf.data(), n);
+            m_rxBuf.erase(0, n);
+            // Nothing new will complete for what is already buffered, so
+            // post a NOP to keep the ring fd readable for the rest.
+            if (!m_rxBuf.empty())
+                kick();
+            return static_cast<ssize_t>(n);
+        }
+        if (m_rxEof)
+            return 0;
+        errno = EAGAIN;
+        return -1;
+    }
+
+    ssize_t write(const char *data, std::size_t len) override
+    {
+        if (m_clientFd < 0 || m_txError)
+        {
+            errno = EPIPE;
+            return -1;
+        }
+        m_txQueue.emplace_back(data, len);
+        if (m_txFlight.empty())
+            submitSends();
+        return static_cast<ssize_t>(len);
+    }
+
+    void send(const std::string &message) override { write(message.data(), message.size()); }
+
+    void receive() override
+    {
+        char buf[1024];
+        ssize_t n = read(buf, sizeof(buf) - 1);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            std::cout << "[Uring] Received: " << buf << "\n";
+        }
+    }
+
+    void shutdown() override
+    {
+        closeClient();
+        for (int fd : m_accepted)
+            ::close(fd);
+        m_accepted.clear();
+        if (m_listenFd >= 0)
+        {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+        }
+        if (m_ringFd >= 0)
+        {
+            ::close(m_ringFd);          // cancels everything still armed
+            m_ringFd = -1;
+        }
+        unmap(m_sqRing, m_sqRingBytes);
+        if (m_cqRing != m_sqRing)
+            unmap(m_cqRing, m_cqRingBytes);
+        m_cqRing = nullptr;
+        unmap(m_sqes, m_sqeBytes);
+        m_freeBids.clear();
+        m_txOrphans.clear();
+        m_orphanCqes = 0;
+    }
+
+private:
+    static constexpr unsigned  kEntries   = 64;
+    static constexpr unsigned  kBufCount  = 64;       // power of two
+    static constexpr unsigned  kBufSize   = 2048;
+    static constexpr uint16_t  kBufGroup  = 0;
+    static constexpr std::size_t kMaxChain = 16;       // sends per linked chain
+
+    // user_data = kind << 56 | connection generation
+    enum Kind : uint64_t { Accept = 1, Recv = 2, Send = 3, Nop = 4 };
+    static uint64_t tag(Kind k, uint64_t gen) { return (uint64_t(k) << 56) | (gen & 0xffffffffffffffULL); }
+
+    // ── Ring setup ───────────────────────────────────────────────────────────
+    bool setupRing()
+    {
+        io_uring_params p{};
+        p.flags = IORING_SETUP_CLAMP;
+        m_ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, kEntries, &p));
+        if (m_ringFd < 0)
+            return false;
+
+        m_sqRingBytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        m_cqRingBytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            m_sqRingBytes = m_cqRingBytes = std::max(m_sqRingBytes, m_cqRingBytes);
+
+        m_sqRing = map(m_sqRingBytes, IORING_OFF_SQ_RING);
+        m_cqRing = single ? m_sqRing : map(m_cqRingBytes, IORING_OFF_CQ_RING);
+        m_sqeBytes = p.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe *>(map(m_sqeBytes, IORING_OFF_SQES));
+        if (!m_sqRing || !m_cqRing || !m_sqes)
+            return false;
+
+        char *sq = static_cast<char *>(m_sqRing);
+        char *cq = static_cast<char *>(m_cqRing);
+        m_sqHead  = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        m_sqTail  = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        m_sqMask  = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        m_sqSize  = p.sq_entries;
+        m_cqHead  = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        m_cqTail  = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        m_cqMask  = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        m_cqes    = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+        m_sqLocal = *m_sqTail;
+        return true;
+    }
+
+    bool setupBuffers()
+    {
+        m_bufs.assign(std::size_t(kBufCount) * kBufSize, 0);
+        provide(0, kBufCount);
+        return true;
+    }
+
+    void *map(std::size_t bytes, off_t offset)
+    {
+        void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         m_ringFd, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    template <typename T>
+    static void unmap(T *&p, std::size_t bytes)
+    {
+        if (p)
+            ::munmap(p, bytes);
+        p = nullptr;
+    }
+
+    // ── Submission ───────────────────────────────────────────────────────────
+    io_uring_sqe *nextSqe()
+    {
+        if (m_sqLocal - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqSize)
+            submit();
+        const unsigned idx = m_sqLocal & m_sqMask;
+        io_uring_sqe *sqe = &m_sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        m_sqArray[idx] = idx;
+        ++m_sqLocal;
+        return sqe;
+    }
+
+    void submit()
+    {
+        const unsigned pending = m_sqLocal - *m_sqTail;
+        if (pending == 0)
+            return;
+        __atomic_store_n(m_sqTail, m_sqLocal, __ATOMIC_RELEASE);
+        while (::syscall(__NR_io_uring_enter, m_ringFd, pending, 0, 0, nullptr, 0) < 0
+               && errno == EINTR)
+            ;
+    }
+
+    void armAccept()
+    {
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode       = IORING_OP_ACCEPT;
+        sqe->fd           = m_listenFd;
+        sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data    = tag(Accept, 0);
+    }
+
+    void armRecv()
+    {
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode    = IORING_OP_RECV;
+        sqe->fd        = m_clientFd;
+        sqe->ioprio    = IORING_RECV_MULTISHOT;
+        sqe->flags     = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufGroup;
+        sqe->user_data = tag(Recv, m_gen);
+    }
+
+    void kick()
+    {
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode    = IORING_OP_NOP;
+        sqe->user_data = tag(Nop, 0);
+        submit();
+    }
+
+    /** Sends every queued message as one linked chain. MSG_WAITALL makes
+     *  the kernel finish a message before the next one starts.          */
+    void submitSends()
+    {
+        const std::size_t n = std::min(m_txQueue.size(), kMaxChain);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            m_txFlight.push_back(std::move(m_txQueue.front()));
+            m_txQueue.pop_front();
+            const std::string &msg = m_txFlight.back();
+
+            io_uring_sqe *sqe = nextSqe();
+            sqe->opcode    = IORING_OP_SEND;
+            sqe->fd        = m_clientFd;
+            sqe->addr      = reinterpret_cast<uint64_t>(msg.data());
+            sqe->len       = static_cast<uint32_t>(msg.size());
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+            sqe->flags     = (i + 1 < n) ? IOSQE_IO_LINK : 0;
+            sqe->user_data = tag(Send, m_gen);
+        }
+        submit();
+    }
+
+    /** Hands `count` buffers starting at `bid` to the kernel. Only a
+     *  failure produces a completion.                                   */
+    void provide(uint16_t bid, unsigned count)
+    {
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode    = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd        = static_cast<int>(count);
+        sqe->addr      = reinterpret_cast<uint64_t>(m_bufs.data() + std::size_t(bid) * kBufSize);
+        sqe->len       = kBufSize;
+        sqe->off       = bid;
+        sqe->buf_group = kBufGroup;
+        sqe->flags     = IOSQE_CQE_SKIP_SUCCESS;
+        sqe->user_data = tag(Nop, 0);
+    }
+
+    void recycleBuffers()
+    {
+        for (uint16_t bid : m_freeBids)
+            provide(bid, 1);
+        m_freeBids.clear();
+    }
+
+    // ── Completion ───────────────────────────────────────────────────────────
+    void reap()
+    {
+        if (m_ringFd < 0)
+            return;
+        unsigned head = *m_cqHead;
+        const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        bool rearm = false;
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+            const Kind     kind = static_cast<Kind>(cqe.user_data >> 56);
+            const bool     live = (cqe.user_data & 0xffffffffffffffULL) == (m_gen & 0xffffffffffffffULL);
+            const bool     more = cqe.flags & IORING_CQE_F_MORE;
+
+            switch (kind)
+            {
+            case Accept:
+                if (cqe.res >= 0)
+                    m_accepted.push_back(cqe.res);
+                if (!more && m_listenFd >= 0)
+                    armAccept();
+                break;
+
+            case Recv:
+                if (cqe.flags & IORING_CQE_F_BUFFER)
+                {
+                    const uint16_t bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+                    if (live && cqe.res > 0)
+                        m_rxBuf.append(m_bufs.data() + std::size_t(bid) * kBufSize,
+                                       static_cast<std::size_t>(cqe.res));
+                    m_freeBids.push_back(bid);
+                }
+                if (!live)
+                    break;
+                if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS))
+                    m_rxEof = true;
+                else if (!more)
+                    rearm = true;       // ran out of buffers or the kernel ended it
+                break;
+
+            case Send:
+                if (live)
+                    onSendDone(cqe.res);
+                else if (m_orphanCqes > 0 && --m_orphanCqes == 0)
+                    m_txOrphans.clear();
+                break;
+
+            case Nop:
+                break;
+            }
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+        // Returning buffers costs a submission, so wait until half the
+        // pool is out, or until the recv stopped for want of them.
+        if (rearm || m_freeBids.size() >= kBufCount / 2)
+            recycleBuffers();
+        if (rearm && m_clientFd >= 0)
+            armRecv();
+        submit();
+    }
+
+    /** Chain completions arrive in submission order. A short or failed
+     *  send cancels the rest of its chain; whatever did not go out is put
+     *  back in front of the queue once the whole chain has reported.    */
+    void onSendDone(int res)
+    {
+        std::string &msg = m_txFlight[m_txAcked++];
+        if (res == static_cast<int>(msg.size()) && !m_txBroken)
+            msg.clear();
+        else if (res >= 0)
+        {
+            msg.erase(0, static_cast<std::size_t>(res));
+            m_txBroken = true;
+        }
+        else if (res == -ECANCELED || res == -EINTR || res == -EAGAIN)
+            m_txBroken = true;
+        else
+            m_txError = true;
+
+        if (m_txAcked < m_txFlight.size())
+            return;
+
+        if (!m_txError)
+        {
+            for (auto it = m_txFlight.rbegin(); it != m_txFlight.rend(); ++it)
+                if (!it->empty())
+                    m_txQueue.push_front(std::move(*it));
+        }
+        m_txFlight.clear();
+        m_txAcked  = 0;
+        m_txBroken = false;
+        if (!m_txError && !m_txQueue.empty())
+            submitSends();
+    }
+
+    uint16_t        m_port;
+    int             m_listenFd  = -1;
+    int             m_clientFd  = -1;
+    int             m_ringFd    = -1;
+    uint64_t        m_gen       = 1;
+    sockaddr_in     m_peer{};
+    std::deque<int> m_accepted;
+
+    void           *m_sqRing      = nullptr;
+    void           *m_cqRing      = nullptr;
+    io_uring_sqe   *m_sqes        = nullptr;
+    std::size_t     m_sqRingBytes = 0;
+    std::size_t     m_cqRingBytes = 0;
+    std::size_t     m_sqeBytes    = 0;
+    unsigned       *m_sqHead = nullptr, *m_sqTail = nullptr, *m_sqArray = nullptr;
+    unsigned       *m_cqHead = nullptr, *m_cqTail = nullptr;
+    unsigned        m_sqMask = 0, m_cqMask = 0, m_sqSize = 0, m_sqLocal = 0;
+    io_uring_cqe   *m_cqes   = nullptr;
+
+    std::vector<char>     m_bufs;
+    std::vector<uint16_t> m_freeBids;        // consumed, not yet provided again
+
+    std::string             m_rxBuf;
+    bool                    m_rxEof    = false;
+    std::deque<std::string> m_txQueue;           // not yet submitted
+    std::deque<std::string> m_txFlight;          // current linked chain
+    std::size_t             m_txAcked  = 0;      // completions seen for it
+    bool                    m_txBroken = false;
+    bool                    m_txError  = false;
+    std::deque<std::deque<std::string>> m_txOrphans;   // closed clients' chains
+    std::size_t             m_orphanCqes = 0;
+};
+
+#endif // IOTPROTO_HAVE_URING
+
+#endif // IOTPROTO_URINGSOCKET_H